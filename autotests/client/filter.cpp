@@ -52,6 +52,7 @@ private Q_SLOTS:
     void cleanup();
     void testFilter_data();
     void testFilter();
+    void testDecisionCache();
 
 private:
     std::unique_ptr<TestDisplay> m_display;
@@ -68,6 +69,7 @@ public:
     TestDisplay();
     bool allowInterface(Wrapland::Server::Client* client, QByteArray const& interfaceName) override;
     QList<wl_client*> m_allowedClients;
+    int m_policyCalls{0};
 };
 
 TestDisplay::TestDisplay()
@@ -77,6 +79,7 @@ TestDisplay::TestDisplay()
 
 bool TestDisplay::allowInterface(Wrapland::Server::Client* client, QByteArray const& interfaceName)
 {
+    m_policyCalls++;
     if (interfaceName == "org_kde_kwin_blur_manager") {
         return m_allowedClients.contains(client->native());
     }
@@ -161,5 +164,79 @@ void TestFilter::testFilter()
     thread->wait();
 }
 
+void TestFilter::testDecisionCache()
+{
+    QVERIFY(!m_display->cache_decisions());
+    m_display->set_cache_decisions(true);
+    QVERIFY(m_display->cache_decisions());
+
+    std::unique_ptr<Wrapland::Client::ConnectionThread> connection(
+        new Wrapland::Client::ConnectionThread());
+    QSignalSpy connectedSpy(connection.get(), &ConnectionThread::establishedChanged);
+    QVERIFY(connectedSpy.isValid());
+    connection->setSocketName(socket_name);
+
+    std::unique_ptr<QThread> thread(new QThread(this));
+    connection->moveToThread(thread.get());
+    thread->start();
+
+    connection->establishConnection();
+    QVERIFY(connectedSpy.count() || connectedSpy.wait());
+    QCOMPARE(connectedSpy.count(), 1);
+
+    Wrapland::Client::EventQueue queue;
+    queue.setup(connection.get());
+
+    auto announce = [&](int& blurCount) {
+        Registry registry;
+        QSignalSpy registryDoneSpy(&registry, &Registry::interfacesAnnounced);
+        QSignalSpy blurSpy(&registry, &Registry::blurAnnounced);
+
+        registry.setEventQueue(&queue);
+        registry.create(connection->display());
+        QVERIFY(registry.isValid());
+        registry.setup();
+
+        QVERIFY(registryDoneSpy.wait());
+        blurCount = blurSpy.count();
+    };
+
+    int blurCount{-1};
+    announce(blurCount);
+    QCOMPARE(blurCount, 0);
+
+    auto const policyCalls = m_display->m_policyCalls;
+    QVERIFY(policyCalls > 0);
+
+    // A second registry of the same client is served from the cache.
+    announce(blurCount);
+    QCOMPARE(blurCount, 0);
+    QCOMPARE(m_display->m_policyCalls, policyCalls);
+
+    // The policy changes. Without invalidation the old decision sticks.
+    QCOMPARE(m_display->clients().size(), 1);
+    auto server_client = m_display->clients().front();
+    m_display->m_allowedClients << server_client->native();
+
+    announce(blurCount);
+    QCOMPARE(blurCount, 0);
+    QCOMPARE(m_display->m_policyCalls, policyCalls);
+
+    m_display->invalidate_decisions(server_client);
+    announce(blurCount);
+    QCOMPARE(blurCount, 1);
+    QCOMPARE(m_display->m_policyCalls, 2 * policyCalls);
+
+    // Global invalidation.
+    m_display->m_allowedClients.clear();
+    m_display->invalidate_decisions();
+    announce(blurCount);
+    QCOMPARE(blurCount, 0);
+    QCOMPARE(m_display->m_policyCalls, 3 * policyCalls);
+
+    thread->quit();
+    thread->wait();
+}
+
 QTEST_GUILESS_MAIN(TestFilter)
 #include "filter.moc"
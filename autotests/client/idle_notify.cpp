@@ -28,6 +28,7 @@ private Q_SLOTS:
     void cleanup();
 
     void testTimeout();
+    void testIdleTracking();
 
 private:
     struct {
@@ -149,5 +150,44 @@ void idle_notify_test::testTimeout()
     QVERIFY(resumedFormIdleSpy.wait());
 }
 
+void idle_notify_test::testIdleTracking()
+{
+    // this test verifies that the seat sends idle and resumed events by itself
+    server.seat->set_idle_tracking(true);
+    QVERIFY(server.seat->idle_tracking());
+
+    QSignalSpy timeout_spy(server.globals.idle_notifier_v1.get(),
+                           &Srv::idle_notifier_v1::notification_created);
+    QVERIFY(timeout_spy.isValid());
+
+    std::unique_ptr<Clt::idle_notification_v1> timeout(m_idle->get_notification(50, m_seat));
+    QVERIFY(timeout->isValid());
+    QSignalSpy idleSpy(timeout.get(), &Clt::idle_notification_v1::idled);
+    QVERIFY(idleSpy.isValid());
+    QSignalSpy resumedFormIdleSpy(timeout.get(), &Clt::idle_notification_v1::resumed);
+    QVERIFY(resumedFormIdleSpy.isValid());
+
+    QVERIFY(timeout_spy.wait());
+    QVERIFY(idleSpy.wait());
+    QCOMPARE(idleSpy.count(), 1);
+
+    // Input sets a new timestamp on the seat.
+    server.seat->setTimestamp(1);
+    QVERIFY(resumedFormIdleSpy.wait());
+    QCOMPARE(resumedFormIdleSpy.count(), 1);
+
+    // The timeout restarts with the activity.
+    QVERIFY(idleSpy.wait());
+    QCOMPARE(idleSpy.count(), 2);
+
+    server.seat->notify_activity();
+    QVERIFY(resumedFormIdleSpy.wait());
+
+    // Once tracking is disabled no events are sent anymore.
+    server.seat->set_idle_tracking(false);
+    QVERIFY(!idleSpy.wait(200));
+    QCOMPARE(idleSpy.count(), 2);
+}
+
 QTEST_GUILESS_MAIN(idle_notify_test)
 #include "idle_notify.moc"
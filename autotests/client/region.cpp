@@ -50,6 +50,7 @@ private Q_SLOTS:
     void testRemove();
     void testDestroy();
     void testDisconnect();
+    void testPooledAllocation();
 
 private:
     struct {
@@ -325,5 +326,33 @@ void TestRegion::testDisconnect()
     QTRY_COMPARE(regionDestroyedSpy.count(), 1);
 }
 
+void TestRegion::testPooledAllocation()
+{
+    // Regions are allocated from a pool. The memory of a destroyed region is used for the next.
+    QSignalSpy regionCreatedSpy(server.globals.compositor.get(),
+                                &Wrapland::Server::Compositor::regionCreated);
+    QVERIFY(regionCreatedSpy.isValid());
+
+    auto const stats = server.display->get_object_pool_stats();
+
+    std::unique_ptr<Wrapland::Client::Region> region(m_compositor->createRegion());
+    QVERIFY(regionCreatedSpy.wait());
+    auto serverRegion = regionCreatedSpy.last().first().value<Wrapland::Server::Region*>();
+
+    QSignalSpy destroyedSpy(serverRegion, &Wrapland::Server::Region::resourceDestroyed);
+    QVERIFY(destroyedSpy.isValid());
+    region.reset();
+    QVERIFY(destroyedSpy.wait());
+
+    region.reset(m_compositor->createRegion());
+    QVERIFY(regionCreatedSpy.wait());
+    QCOMPARE(regionCreatedSpy.count(), 2);
+
+    // Both the region and its private part are pooled.
+    auto const current = server.display->get_object_pool_stats();
+    QCOMPARE(current.allocations - stats.allocations, 4);
+    QVERIFY(current.reused - stats.reused >= 2);
+}
+
 QTEST_GUILESS_MAIN(TestRegion)
 #include "region.moc"
@@ -62,6 +62,8 @@ private Q_SLOTS:
     void testRemoveSurface();
     void testMappingOfSurfaceTree();
     void testSurfaceAt();
+    void testSurfaceAtIndex();
+    void testVisibleRegions();
     void testDestroyAttachedBuffer();
     void testDestroyParentSurface();
 
@@ -1282,6 +1284,282 @@ void TestSubsurface::testSurfaceAt()
     QVERIFY(!WST::input_surface_at(serverParent, QPointF(125, 126)));
 }
 
+void TestSubsurface::testSurfaceAtIndex()
+{
+    // This test verifies that the hit test index of a surface tree follows commits.
+
+    QImage parentImage(QSize(100, 100), QImage::Format_ARGB32_Premultiplied);
+    parentImage.fill(Qt::red);
+    QImage childImage(QSize(50, 50), QImage::Format_ARGB32_Premultiplied);
+    childImage.fill(Qt::green);
+
+    QSignalSpy serverSurfaceCreated(server.globals.compositor.get(),
+                                    &Wrapland::Server::Compositor::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+
+    std::unique_ptr<Wrapland::Client::Surface> parent(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverParent = serverSurfaceCreated.last().first().value<Wrapland::Server::Surface*>();
+    QVERIFY(serverParent);
+
+    // Nothing is picked before the surface is mapped.
+    QVERIFY(!serverParent->surface_at(QPointF(10, 10)).surface);
+
+    QSignalSpy parentCommitSpy(serverParent, &Wrapland::Server::Surface::committed);
+    QVERIFY(parentCommitSpy.isValid());
+
+    parent->attachBuffer(m_shm->createBuffer(parentImage));
+    parent->damage(QRect(0, 0, 100, 100));
+    parent->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommitSpy.wait());
+
+    auto hit = serverParent->surface_at(QPointF(10.5, 20.5));
+    QCOMPARE(hit.surface, serverParent);
+    QCOMPARE(hit.position, QPointF(10.5, 20.5));
+
+    // Right and bottom edges are exclusive.
+    QCOMPARE(serverParent->surface_at(QPointF(99.9, 0)).surface, serverParent);
+    QVERIFY(!serverParent->surface_at(QPointF(100, 50)).surface);
+    QVERIFY(!serverParent->surface_at(QPointF(50, 100)).surface);
+    QVERIFY(!serverParent->surface_at(QPointF(-0.5, 50)).surface);
+
+    // Two children, the second one above the first one.
+    std::unique_ptr<Wrapland::Client::Surface> child1(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverChild1 = serverSurfaceCreated.last().first().value<Wrapland::Server::Surface*>();
+    QVERIFY(serverChild1);
+
+    std::unique_ptr<Wrapland::Client::Surface> child2(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverChild2 = serverSurfaceCreated.last().first().value<Wrapland::Server::Surface*>();
+    QVERIFY(serverChild2);
+
+    std::unique_ptr<Wrapland::Client::SubSurface> child1Sub(
+        m_subCompositor->createSubSurface(*child1, *parent));
+    child1Sub->setMode(Wrapland::Client::SubSurface::Mode::Desynchronized);
+    child1Sub->setPosition(QPoint(20, 20));
+    child1->attachBuffer(m_shm->createBuffer(childImage));
+    child1->damage(QRect(0, 0, 50, 50));
+    child1->commit(Wrapland::Client::Surface::CommitFlag::None);
+
+    std::unique_ptr<Wrapland::Client::SubSurface> child2Sub(
+        m_subCompositor->createSubSurface(*child2, *parent));
+    child2Sub->setMode(Wrapland::Client::SubSurface::Mode::Desynchronized);
+    child2Sub->setPosition(QPoint(40, 40));
+    child2->attachBuffer(m_shm->createBuffer(childImage));
+    child2->damage(QRect(0, 0, 50, 50));
+    child2->commit(Wrapland::Client::Surface::CommitFlag::None);
+
+    parent->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommitSpy.wait());
+    QVERIFY(serverChild1->isMapped());
+    QVERIFY(serverChild2->isMapped());
+
+    hit = serverParent->surface_at(QPointF(45, 45));
+    QCOMPARE(hit.surface, serverChild2);
+    QCOMPARE(hit.position, QPointF(5, 5));
+
+    hit = serverParent->surface_at(QPointF(30, 30));
+    QCOMPARE(hit.surface, serverChild1);
+    QCOMPARE(hit.position, QPointF(10, 10));
+
+    QCOMPARE(serverParent->surface_at(QPointF(89.5, 89.5)).surface, serverChild2);
+    QCOMPARE(serverParent->surface_at(QPointF(95, 95)).surface, serverParent);
+    QVERIFY(!serverParent->surface_at(QPointF(90, 100)).surface);
+
+    // A child surface as root only picks itself and its own subsurfaces.
+    hit = serverChild1->surface_at(QPointF(25, 25));
+    QCOMPARE(hit.surface, serverChild1);
+    QCOMPARE(hit.position, QPointF(25, 25));
+
+    // Raising the first child applies on the next parent commit.
+    child1Sub->raise();
+    parent->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommitSpy.wait());
+    QCOMPARE(serverParent->surface_at(QPointF(45, 45)).surface, serverChild1);
+
+    // Limit the input of the first child to its top-left quadrant.
+    QSignalSpy child1CommitSpy(serverChild1, &Wrapland::Server::Surface::committed);
+    QVERIFY(child1CommitSpy.isValid());
+    child1->setInputRegion(m_compositor->createRegion(QRegion(0, 0, 25, 25)).get());
+    child1->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(child1CommitSpy.wait());
+
+    QCOMPARE(serverParent->surface_at(QPointF(44, 44)).surface, serverChild1);
+    QCOMPARE(serverParent->surface_at(QPointF(45, 45)).surface, serverChild2);
+
+    // An empty input region lets all input through to the surfaces below.
+    QSignalSpy child2CommitSpy(serverChild2, &Wrapland::Server::Surface::committed);
+    QVERIFY(child2CommitSpy.isValid());
+    child2->setInputRegion(m_compositor->createRegion(QRegion()).get());
+    child2->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(child2CommitSpy.wait());
+
+    QCOMPARE(serverParent->surface_at(QPointF(45, 45)).surface, serverParent);
+    QCOMPARE(serverParent->surface_at(QPointF(80, 80)).surface, serverParent);
+    QVERIFY(!serverParent->surface_at(QPointF(89, 100)).surface);
+
+    // Moving the first child.
+    child1Sub->setPosition(QPoint(0, 0));
+    parent->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommitSpy.wait());
+
+    hit = serverParent->surface_at(QPointF(10, 10));
+    QCOMPARE(hit.surface, serverChild1);
+    QCOMPARE(hit.position, QPointF(10, 10));
+    QCOMPARE(serverParent->surface_at(QPointF(30, 30)).surface, serverParent);
+
+    // Unmapping the first child.
+    child1->attachBuffer(static_cast<wl_buffer*>(nullptr));
+    child1->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(child1CommitSpy.wait());
+    QVERIFY(!serverChild1->isMapped());
+    QCOMPARE(serverParent->surface_at(QPointF(10, 10)).surface, serverParent);
+
+    // Destroying the second child's subsurface removes it from the tree.
+    child2->setInputRegion(nullptr);
+    child2->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(child2CommitSpy.wait());
+    QCOMPARE(serverParent->surface_at(QPointF(80, 80)).surface, serverChild2);
+
+    QSignalSpy treeChangedSpy(serverParent, &Wrapland::Server::Surface::subsurfaceTreeChanged);
+    QVERIFY(treeChangedSpy.isValid());
+    child2Sub.reset();
+    QVERIFY(treeChangedSpy.wait());
+    QCOMPARE(serverParent->surface_at(QPointF(80, 80)).surface, serverParent);
+}
+
+void TestSubsurface::testVisibleRegions()
+{
+    // This test verifies that opaque content hides what is below it in a surface tree.
+
+    QImage parentImage(QSize(100, 100), QImage::Format_ARGB32_Premultiplied);
+    parentImage.fill(Qt::transparent);
+    QImage alphaImage(QSize(50, 50), QImage::Format_ARGB32_Premultiplied);
+    alphaImage.fill(Qt::transparent);
+    QImage opaqueImage(QSize(50, 50), QImage::Format_RGB32);
+    opaqueImage.fill(Qt::blue);
+
+    QSignalSpy serverSurfaceCreated(server.globals.compositor.get(),
+                                    &Wrapland::Server::Compositor::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+
+    std::unique_ptr<Wrapland::Client::Surface> parent(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverParent = serverSurfaceCreated.last().first().value<Wrapland::Server::Surface*>();
+    QVERIFY(serverParent);
+
+    std::unique_ptr<Wrapland::Client::Surface> child1(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverChild1 = serverSurfaceCreated.last().first().value<Wrapland::Server::Surface*>();
+    QVERIFY(serverChild1);
+
+    std::unique_ptr<Wrapland::Client::Surface> child2(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverChild2 = serverSurfaceCreated.last().first().value<Wrapland::Server::Surface*>();
+    QVERIFY(serverChild2);
+
+    QVERIFY(serverParent->visible_regions(QPoint(), QRect(0, 0, 1000, 1000)).empty());
+
+    // The first child has an opaque left half, the second child above it no alpha channel.
+    std::unique_ptr<Wrapland::Client::SubSurface> child1Sub(
+        m_subCompositor->createSubSurface(*child1, *parent));
+    child1Sub->setMode(Wrapland::Client::SubSurface::Mode::Desynchronized);
+    child1Sub->setPosition(QPoint(20, 20));
+    child1->attachBuffer(m_shm->createBuffer(alphaImage));
+    child1->setOpaqueRegion(m_compositor->createRegion(QRegion(0, 0, 25, 50)).get());
+    child1->damage(QRect(0, 0, 50, 50));
+    child1->commit(Wrapland::Client::Surface::CommitFlag::None);
+
+    std::unique_ptr<Wrapland::Client::SubSurface> child2Sub(
+        m_subCompositor->createSubSurface(*child2, *parent));
+    child2Sub->setMode(Wrapland::Client::SubSurface::Mode::Desynchronized);
+    child2Sub->setPosition(QPoint(40, 40));
+    child2->attachBuffer(m_shm->createBuffer(opaqueImage));
+    child2->damage(QRect(0, 0, 50, 50));
+    child2->commit(Wrapland::Client::Surface::CommitFlag::None);
+
+    QSignalSpy parentCommitSpy(serverParent, &Wrapland::Server::Surface::committed);
+    QVERIFY(parentCommitSpy.isValid());
+    parent->attachBuffer(m_shm->createBuffer(parentImage));
+    parent->damage(QRect(0, 0, 100, 100));
+    parent->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommitSpy.wait());
+    QVERIFY(serverChild2->isMapped());
+    QVERIFY(!serverChild2->state().buffer->hasAlphaChannel());
+
+    auto visible = serverParent->visible_regions(QPoint(), QRect(0, 0, 1000, 1000));
+    QCOMPARE(visible.size(), 3);
+
+    QCOMPARE(visible.at(0).surface, serverParent);
+    QCOMPARE(visible.at(0).offset, QPoint());
+    QCOMPARE(visible.at(0).region,
+             QRegion(0, 0, 100, 100) - QRegion(40, 40, 50, 50) - QRegion(20, 20, 25, 50));
+
+    QCOMPARE(visible.at(1).surface, serverChild1);
+    QCOMPARE(visible.at(1).offset, QPoint(20, 20));
+    QCOMPARE(visible.at(1).region, QRegion(0, 0, 50, 50) - QRegion(20, 20, 30, 30));
+
+    QCOMPARE(visible.at(2).surface, serverChild2);
+    QCOMPARE(visible.at(2).offset, QPoint(40, 40));
+    QCOMPARE(visible.at(2).region, QRegion(0, 0, 50, 50));
+
+    // Placed somewhere else and clipped. The regions stay in local coordinates.
+    visible = serverParent->visible_regions(QPoint(100, 200), QRect(100, 200, 60, 60));
+    QCOMPARE(visible.size(), 3);
+    QCOMPARE(visible.at(0).region,
+             QRegion(0, 0, 60, 60) - QRegion(40, 40, 20, 20) - QRegion(20, 20, 25, 40));
+    QCOMPARE(visible.at(1).region, QRegion(0, 0, 40, 40) - QRegion(20, 20, 20, 20));
+    QCOMPARE(visible.at(2).region, QRegion(0, 0, 20, 20));
+
+    // A clip fully covered by the second child hides everything below it.
+    visible = serverParent->visible_regions(QPoint(), QRect(50, 50, 30, 30));
+    QVERIFY(visible.at(0).region.isEmpty());
+    QVERIFY(visible.at(1).region.isEmpty());
+    QCOMPARE(visible.at(2).region, QRegion(10, 10, 30, 30));
+
+    // Moving the first child below the second one.
+    child1Sub->setPosition(QPoint(40, 40));
+    parent->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommitSpy.wait());
+
+    visible = serverParent->visible_regions(QPoint(), QRect(0, 0, 1000, 1000));
+    QCOMPARE(visible.size(), 3);
+    QCOMPARE(visible.at(1).surface, serverChild1);
+    QVERIFY(visible.at(1).region.isEmpty());
+    QCOMPARE(visible.at(0).region, QRegion(0, 0, 100, 100) - QRegion(40, 40, 50, 50));
+
+    // A buffer with alpha channel on the second child shows the first child again.
+    QSignalSpy child2CommitSpy(serverChild2, &Wrapland::Server::Surface::committed);
+    QVERIFY(child2CommitSpy.isValid());
+    child2->attachBuffer(m_shm->createBuffer(alphaImage));
+    child2->damage(QRect(0, 0, 50, 50));
+    child2->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(child2CommitSpy.wait());
+
+    visible = serverParent->visible_regions(QPoint(), QRect(0, 0, 1000, 1000));
+    QCOMPARE(visible.at(1).region, QRegion(0, 0, 50, 50));
+    QCOMPARE(visible.at(0).region, QRegion(0, 0, 100, 100) - QRegion(40, 40, 25, 50));
+
+    // Unless the second child announces opaque content.
+    child2->setOpaqueRegion(m_compositor->createRegion(QRegion(0, 0, 50, 25)).get());
+    child2->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(child2CommitSpy.wait());
+
+    visible = serverParent->visible_regions(QPoint(), QRect(0, 0, 1000, 1000));
+    QCOMPARE(visible.at(1).region, QRegion(0, 25, 50, 25));
+
+    // Unmapped surfaces are not part of the result.
+    child2->attachBuffer(static_cast<wl_buffer*>(nullptr));
+    child2->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(child2CommitSpy.wait());
+
+    visible = serverParent->visible_regions(QPoint(), QRect(0, 0, 1000, 1000));
+    QCOMPARE(visible.size(), 2);
+    QCOMPARE(visible.at(1).surface, serverChild1);
+    QCOMPARE(visible.at(1).region, QRegion(0, 0, 50, 50));
+}
+
 void TestSubsurface::testDestroyAttachedBuffer()
 {
     // this test verifies that destroying of a buffer attached to a sub-surface works
@@ -54,17 +54,23 @@ private Q_SLOTS:
 
     void testStaticAccessor();
     void testDamage();
+    void testDamageRectLimit();
     void testFrameCallback();
+    void testFramesRendered();
     void testAttachBuffer();
     void testMultipleSurfaces();
     void testOpaque();
     void testInput();
     void testScale();
+    void testBufferTransform();
     void testDestroy();
     void testUnmapOfNotMappedSurface();
     void testDamageTracking();
     void testSurfaceAt();
     void testDestroyAttachedBuffer();
+    void testBufferLookup();
+    void testReattachBuffer();
+    void testBatchedBufferRelease();
     void testDestroyWithPendingCallback();
     void testDisconnect();
     void testOutput();
@@ -348,6 +354,53 @@ void TestSurface::testDamage()
     QVERIFY(serverSurface->isMapped());
 }
 
+void TestSurface::testDamageRectLimit()
+{
+    // This test verifies that damage collapses to its bounding rectangle with too many rectangles.
+    server.display->set_damage_rect_limit(4);
+    QCOMPARE(server.display->damage_rect_limit(), 4);
+
+    QSignalSpy serverSurfaceCreated(server.globals.compositor.get(),
+                                    &Wrapland::Server::Compositor::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+    std::unique_ptr<Wrapland::Client::Surface> s{m_compositor->createSurface()};
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverSurface = serverSurfaceCreated.first().first().value<Wrapland::Server::Surface*>();
+    QVERIFY(serverSurface);
+
+    QSignalSpy committedSpy(serverSurface, &Wrapland::Server::Surface::committed);
+    QVERIFY(committedSpy.isValid());
+
+    QImage img(QSize(100, 100), QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::black);
+
+    // Up to the limit damage is the union of the rectangles.
+    QRegion damage;
+    for (int i = 0; i < 4; i++) {
+        damage += QRect(i * 20, i * 20, 10, 10);
+    }
+    s->attachBuffer(m_shm->createBuffer(img));
+    s->damage(damage);
+    s->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(serverSurface->state().damage, damage);
+
+    // One more and it is the bounding rectangle.
+    damage += QRect(80, 80, 10, 10);
+    s->attachBuffer(m_shm->createBuffer(img));
+    s->damage(damage);
+    s->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(serverSurface->state().damage, QRegion(0, 0, 90, 90));
+
+    // Buffer damage is collected the same way.
+    s->attachBuffer(m_shm->createBuffer(img));
+    s->damageBuffer(damage);
+    s->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(serverSurface->state().damage, QRegion(0, 0, 90, 90));
+}
+
 void TestSurface::testFrameCallback()
 {
     QSignalSpy serverSurfaceCreated(server.globals.compositor.get(),
@@ -376,6 +429,50 @@ void TestSurface::testFrameCallback()
     QVERIFY(!frameRenderedSpy.isEmpty());
 }
 
+void TestSurface::testFramesRendered()
+{
+    // This test verifies that frame callbacks of multiple surfaces are sent with a single flush.
+    QSignalSpy serverSurfaceCreated(server.globals.compositor.get(),
+                                    &Wrapland::Server::Compositor::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+
+    QImage img(QSize(10, 10), QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::black);
+
+    std::vector<std::unique_ptr<Wrapland::Client::Surface>> surfaces;
+    std::vector<Wrapland::Server::Surface*> server_surfaces;
+    std::vector<std::unique_ptr<QSignalSpy>> frame_spies;
+
+    for (int i = 0; i < 3; i++) {
+        surfaces.emplace_back(m_compositor->createSurface());
+        QVERIFY(serverSurfaceCreated.wait());
+        server_surfaces.push_back(
+            serverSurfaceCreated.last().first().value<Wrapland::Server::Surface*>());
+
+        QSignalSpy commit_spy(server_surfaces.back(), &Wrapland::Server::Surface::committed);
+        QVERIFY(commit_spy.isValid());
+
+        frame_spies.push_back(std::make_unique<QSignalSpy>(
+            surfaces.back().get(), &Wrapland::Client::Surface::frameRendered));
+        QVERIFY(frame_spies.back()->isValid());
+
+        surfaces.back()->attachBuffer(m_shm->createBuffer(img));
+        surfaces.back()->damage(QRect(0, 0, 10, 10));
+        surfaces.back()->commit();
+        QVERIFY(commit_spy.wait());
+    }
+
+    auto const stats = server.display->get_client_flush_stats();
+    server.display->frames_rendered(server_surfaces, 10);
+
+    // All surfaces belong to the same client.
+    QCOMPARE(server.display->get_client_flush_stats().clients_flushed, stats.clients_flushed + 1);
+
+    for (auto const& spy : frame_spies) {
+        QVERIFY(spy->count() == 1 || spy->wait());
+    }
+}
+
 void TestSurface::testAttachBuffer()
 {
     // create the surface
@@ -820,6 +917,59 @@ void TestSurface::testScale()
     QCOMPARE(serverSurface->size(), QSize(25, 25));
 }
 
+void TestSurface::testBufferTransform()
+{
+    // This test verifies that buffer transforms rotate the surface size and the buffer damage.
+
+    QSignalSpy serverSurfaceCreated(server.globals.compositor.get(),
+                                    &Wrapland::Server::Compositor::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+
+    std::unique_ptr<Wrapland::Client::Surface> s(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverSurface = serverSurfaceCreated.first().first().value<Wrapland::Server::Surface*>();
+    QVERIFY(serverSurface);
+
+    QSignalSpy commit_spy(serverSurface, &Wrapland::Server::Surface::committed);
+    QVERIFY(commit_spy.isValid());
+
+    QImage img(QSize(100, 50), QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::black);
+
+    // Rotated by 90 degrees the buffer's left edge is at the bottom of the surface.
+    s->attachBuffer(m_shm->createBuffer(img));
+    wl_surface_set_buffer_transform(*s, WL_OUTPUT_TRANSFORM_90);
+    s->damageBuffer(QRect(0, 0, 10, 5));
+    s->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(commit_spy.wait());
+
+    QVERIFY(serverSurface->state().updates & Wrapland::Server::surface_change::transform);
+    QVERIFY(serverSurface->state().transform == Wrapland::Server::output_transform::rotated_90);
+    QCOMPARE(serverSurface->size(), QSize(50, 100));
+    QCOMPARE(serverSurface->state().damage, QRegion(0, 90, 5, 10));
+
+    // Rotated by 270 degrees the buffer's top edge is at the right of the surface.
+    s->attachBuffer(m_shm->createBuffer(img));
+    wl_surface_set_buffer_transform(*s, WL_OUTPUT_TRANSFORM_270);
+    s->damageBuffer(QRect(0, 0, 10, 5));
+    s->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(commit_spy.wait());
+
+    QVERIFY(serverSurface->state().transform == Wrapland::Server::output_transform::rotated_270);
+    QCOMPARE(serverSurface->state().updates & Wrapland::Server::surface_change::size, false);
+    QCOMPARE(serverSurface->size(), QSize(50, 100));
+    QCOMPARE(serverSurface->state().damage, QRegion(45, 0, 5, 10));
+
+    // Back to normal without a new buffer the size changes again.
+    wl_surface_set_buffer_transform(*s, WL_OUTPUT_TRANSFORM_NORMAL);
+    s->commit(Wrapland::Client::Surface::CommitFlag::None);
+    QVERIFY(commit_spy.wait());
+
+    QVERIFY(serverSurface->state().transform == Wrapland::Server::output_transform::normal);
+    QVERIFY(serverSurface->state().updates & Wrapland::Server::surface_change::size);
+    QCOMPARE(serverSurface->size(), QSize(100, 50));
+}
+
 void TestSurface::testDestroy()
 {
     using namespace Wrapland::Client;
@@ -1010,6 +1160,176 @@ void TestSurface::testDestroyAttachedBuffer()
     QVERIFY(!serverSurface->state().buffer);
 }
 
+void TestSurface::testBufferLookup()
+{
+    // This test verifies that server buffers are found through their wl_buffer resource.
+
+    QSignalSpy serverSurfaceCreated(server.globals.compositor.get(),
+                                    &Wrapland::Server::Compositor::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+    std::unique_ptr<Wrapland::Client::Surface> s(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverSurface = serverSurfaceCreated.first().first().value<Wrapland::Server::Surface*>();
+
+    QSignalSpy commit_spy(serverSurface, &Wrapland::Server::Surface::committed);
+    QVERIFY(commit_spy.isValid());
+
+    QImage image(QSize(10, 10), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::red);
+
+    std::vector<std::shared_ptr<Wrapland::Client::Buffer>> client_buffers;
+    for (int i = 0; i < 10; i++) {
+        client_buffers.push_back(m_shm->createBuffer(image).lock());
+    }
+
+    for (auto const& buffer : client_buffers) {
+        s->attachBuffer(buffer);
+        s->damage(QRect(0, 0, 10, 10));
+        s->commit(Wrapland::Client::Surface::CommitFlag::None);
+        QVERIFY(commit_spy.wait());
+
+        auto current = serverSurface->state().buffer;
+        QVERIFY(current);
+        QCOMPARE(Wrapland::Server::Buffer::get(server.display.get(), current->resource()), current);
+    }
+
+    // Destroying the wl_buffer removes it from the lookup.
+    auto current = serverSurface->state().buffer;
+    QSignalSpy destroySpy(current.get(), &Wrapland::Server::Buffer::resourceDestroyed);
+    QVERIFY(destroySpy.isValid());
+
+    client_buffers.clear();
+    delete m_shm;
+    m_shm = nullptr;
+
+    QVERIFY(destroySpy.count() || destroySpy.wait());
+    QVERIFY(!current->resource());
+    QVERIFY(!serverSurface->state().buffer);
+}
+
+void TestSurface::testReattachBuffer()
+{
+    // This test verifies that a wl_buffer attached repeatedly is represented by one server buffer
+    // and that it is released for every attachment.
+
+    QSignalSpy serverSurfaceCreated(server.globals.compositor.get(),
+                                    &Wrapland::Server::Compositor::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+    std::unique_ptr<Wrapland::Client::Surface> s(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    auto serverSurface = serverSurfaceCreated.first().first().value<Wrapland::Server::Surface*>();
+
+    QSignalSpy commit_spy(serverSurface, &Wrapland::Server::Surface::committed);
+    QVERIFY(commit_spy.isValid());
+
+    QImage image(QSize(10, 10), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::red);
+    auto buffer1 = m_shm->createBuffer(image).lock();
+    buffer1->setUsed(true);
+    image.fill(Qt::blue);
+    auto buffer2 = m_shm->createBuffer(image).lock();
+    buffer2->setUsed(true);
+
+    auto commit_buffer = [&](auto const& buffer) {
+        s->attachBuffer(buffer);
+        s->damage(QRect(0, 0, 10, 10));
+        s->commit(Wrapland::Client::Surface::CommitFlag::None);
+        return commit_spy.wait();
+    };
+
+    QVERIFY(commit_buffer(buffer1));
+    auto server_buffer1 = serverSurface->state().buffer.get();
+    QVERIFY(server_buffer1);
+    QCOMPARE(server_buffer1->surface(), serverSurface);
+
+    QVERIFY(commit_buffer(buffer2));
+    auto server_buffer2 = serverSurface->state().buffer.get();
+    QVERIFY(server_buffer2 != server_buffer1);
+    QTRY_VERIFY(buffer1->isReleased());
+
+    buffer1->setReleased(false);
+    QVERIFY(commit_buffer(buffer1));
+    QCOMPARE(serverSurface->state().buffer.get(), server_buffer1);
+    QTRY_VERIFY(buffer2->isReleased());
+
+    buffer2->setReleased(false);
+    QVERIFY(commit_buffer(buffer2));
+    QCOMPARE(serverSurface->state().buffer.get(), server_buffer2);
+    QTRY_VERIFY(buffer1->isReleased());
+
+    // Attaching the current buffer again does not release it.
+    buffer2->setReleased(false);
+    QVERIFY(commit_buffer(buffer2));
+    QCOMPARE(serverSurface->state().buffer.get(), server_buffer2);
+    QVERIFY(!buffer2->isReleased());
+
+    // A buffer held by the compositor does not point to its surface after that is gone.
+    auto held = serverSurface->state().buffer;
+    QCOMPARE(held->surface(), serverSurface);
+
+    QSignalSpy destroyedSpy(serverSurface, &QObject::destroyed);
+    QVERIFY(destroyedSpy.isValid());
+    s.reset();
+    QVERIFY(destroyedSpy.wait());
+    QVERIFY(!held->surface());
+}
+
+void TestSurface::testBatchedBufferRelease()
+{
+    // This test verifies that buffer releases are queued and flushed together.
+
+    QSignalSpy serverSurfaceCreated(server.globals.compositor.get(),
+                                    &Wrapland::Server::Compositor::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+
+    QImage image(QSize(10, 10), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::red);
+
+    std::vector<std::unique_ptr<Wrapland::Client::Surface>> surfaces;
+    std::vector<std::shared_ptr<Wrapland::Client::Buffer>> client_buffers;
+    std::vector<std::shared_ptr<Wrapland::Server::Buffer>> server_buffers;
+
+    for (int i = 0; i < 3; i++) {
+        surfaces.emplace_back(m_compositor->createSurface());
+        QVERIFY(serverSurfaceCreated.wait());
+        auto serverSurface
+            = serverSurfaceCreated.last().first().value<Wrapland::Server::Surface*>();
+        QSignalSpy commit_spy(serverSurface, &Wrapland::Server::Surface::committed);
+        QVERIFY(commit_spy.isValid());
+
+        client_buffers.push_back(m_shm->createBuffer(image).lock());
+        client_buffers.back()->setUsed(true);
+
+        surfaces.back()->attachBuffer(client_buffers.back());
+        surfaces.back()->damage(QRect(0, 0, 10, 10));
+        surfaces.back()->commit(Wrapland::Client::Surface::CommitFlag::None);
+        QVERIFY(commit_spy.wait());
+
+        // Hold on to the buffer like a compositor would while rendering it.
+        server_buffers.push_back(serverSurface->state().buffer);
+
+        surfaces.back()->attachBuffer(static_cast<wl_buffer*>(nullptr));
+        surfaces.back()->commit(Wrapland::Client::Surface::CommitFlag::None);
+        QVERIFY(commit_spy.wait());
+        QVERIFY(!serverSurface->state().buffer);
+    }
+
+    auto const stats = server.display->get_buffer_release_stats();
+
+    // All three buffers are released at once.
+    server_buffers.clear();
+    server.display->flush();
+
+    auto const new_stats = server.display->get_buffer_release_stats();
+    QCOMPARE(new_stats.sent, stats.sent + 3);
+    QCOMPARE(new_stats.immediate, stats.immediate);
+    QCOMPARE(new_stats.flushes_saved, stats.flushes_saved + 2);
+
+    for (auto const& buffer : client_buffers) {
+        QTRY_VERIFY(buffer->isReleased());
+    }
+}
+
 void TestSurface::testDestroyWithPendingCallback()
 {
     // this test tries to verify that destroying a surface with a pending callback works correctly
@@ -0,0 +1,103 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include <QtTest>
+
+#include "../../server/compositor.h"
+#include "../../server/display.h"
+#include "../../server/subcompositor.h"
+#include "../../server/surface.h"
+
+#include "raw_clients.h"
+
+#include <chrono>
+#include <memory>
+
+namespace
+{
+constexpr int run_count{10};
+}
+
+/**
+ * Server time for destroying a client that disconnects with many objects alive. Every subsurface
+ * has its own surface, a region and a pending frame callback, so each one adds four objects.
+ */
+class BenchClientTeardown : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchDisconnect_data();
+    void benchDisconnect();
+};
+
+void BenchClientTeardown::benchDisconnect_data()
+{
+    QTest::addColumn<int>("subsurfaces");
+
+    QTest::newRow("1k objects") << 250;
+    QTest::newRow("10k objects") << 2500;
+}
+
+void BenchClientTeardown::benchDisconnect()
+{
+    QFETCH(int, subsurfaces);
+
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("wrapland-bench-client-teardown-0"));
+    display.start_external_loop();
+    QVERIFY(display.running());
+
+    Wrapland::Server::Compositor compositor(&display);
+    Wrapland::Server::Subcompositor subcompositor(&display);
+
+    std::chrono::nanoseconds server_time{0};
+
+    for (int run = 0; run < run_count; run++) {
+        Wrapland::Server::Test::raw_clients raw_clients;
+        Wrapland::Server::Test::connect_clients(display, 1, raw_clients);
+
+        auto& client = *raw_clients.front();
+        QVERIFY(client.subcompositor);
+
+        // The child surfaces are created before the parent. On disconnect libwayland destroys
+        // objects in creation order, so the parent loses its children one by one.
+        std::vector<wl_surface*> children;
+        for (int i = 0; i < subsurfaces; i++) {
+            children.push_back(wl_compositor_create_surface(client.compositor));
+        }
+        auto parent = wl_compositor_create_surface(client.compositor);
+
+        for (auto child : children) {
+            auto subsurface = wl_subcompositor_get_subsurface(client.subcompositor, child, parent);
+            wl_subsurface_set_position(subsurface, 10, 10);
+
+            auto region = wl_compositor_create_region(client.compositor);
+            wl_region_add(region, 0, 0, 10, 10);
+            wl_surface_set_input_region(child, region);
+
+            wl_surface_frame(child);
+            wl_surface_commit(child);
+        }
+        wl_surface_commit(parent);
+
+        Wrapland::Server::Test::sync_clients(display, raw_clients);
+        QCOMPARE(display.clients().size(), 1);
+
+        auto const start = std::chrono::steady_clock::now();
+
+        raw_clients.clear();
+        while (!display.clients().empty()) {
+            display.dispatch();
+        }
+
+        server_time += std::chrono::steady_clock::now() - start;
+    }
+
+    QTest::setBenchmarkResult(static_cast<qreal>(server_time.count()) / run_count,
+                              QTest::WalltimeNanoseconds);
+}
+
+QTEST_GUILESS_MAIN(BenchClientTeardown)
+#include "bench_client_teardown.moc"
@@ -0,0 +1,129 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include <QtTest>
+
+#include "../../server/client.h"
+#include "../../server/compositor.h"
+#include "../../server/display.h"
+#include "../../server/output.h"
+#include "../../server/output_manager.h"
+#include "../../server/surface.h"
+
+#include "raw_clients.h"
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+constexpr size_t client_count{500};
+constexpr size_t output_count{4};
+}
+
+class BenchOutputBinds : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void benchEnterLeave();
+
+private:
+    std::unique_ptr<Wrapland::Server::Display> display;
+    std::unique_ptr<Wrapland::Server::output_manager> output_manager;
+    std::vector<std::unique_ptr<Wrapland::Server::output>> outputs;
+    std::unique_ptr<Wrapland::Server::Compositor> compositor;
+
+    Wrapland::Server::Test::raw_clients clients;
+    std::vector<Wrapland::Server::Surface*> surfaces;
+};
+
+void BenchOutputBinds::init()
+{
+    Wrapland::Server::Test::raise_fd_limit(client_count);
+
+    display = std::make_unique<Wrapland::Server::Display>();
+    display->set_socket_name(std::string("wrapland-bench-output-binds-0"));
+    display->start();
+
+    output_manager = std::make_unique<Wrapland::Server::output_manager>(*display);
+    for (size_t i = 0; i < output_count; i++) {
+        auto output = std::make_unique<Wrapland::Server::output>(*output_manager);
+        auto state = output->get_state();
+        state.enabled = true;
+        output->set_state(state);
+        output->done();
+        outputs.push_back(std::move(output));
+    }
+
+    compositor = std::make_unique<Wrapland::Server::Compositor>(display.get());
+    connect(compositor.get(),
+            &Wrapland::Server::Compositor::surfaceCreated,
+            this,
+            [this](auto surface) { surfaces.push_back(surface); });
+
+    Wrapland::Server::Test::connect_clients(*display, client_count, clients);
+    for (auto const& client : clients) {
+        QCOMPARE(client->outputs.size(), output_count);
+    }
+    QCOMPARE(surfaces.size(), client_count);
+}
+
+void BenchOutputBinds::cleanup()
+{
+    surfaces.clear();
+    clients.clear();
+    compositor.reset();
+    outputs.clear();
+    output_manager.reset();
+    display.reset();
+}
+
+void BenchOutputBinds::benchEnterLeave()
+{
+    // Each of the clients has bound every output. A surface must only be notified about the
+    // binds of its own client.
+    std::vector<Wrapland::Server::output*> all_outputs;
+    for (auto const& output : outputs) {
+        all_outputs.push_back(output.get());
+    }
+
+    for (auto surface : surfaces) {
+        surface->setOutputs(all_outputs);
+    }
+    Wrapland::Server::Test::sync_clients(*display, clients);
+    for (auto const& client : clients) {
+        QCOMPARE(client->entered, static_cast<int>(output_count));
+    }
+
+    for (auto surface : surfaces) {
+        surface->setOutputs(std::vector<Wrapland::Server::output*>());
+    }
+    Wrapland::Server::Test::sync_clients(*display, clients);
+    for (auto const& client : clients) {
+        QCOMPARE(client->entered, 0);
+    }
+
+    QBENCHMARK
+    {
+        for (auto surface : surfaces) {
+            surface->setOutputs(all_outputs);
+        }
+        for (auto surface : surfaces) {
+            surface->setOutputs(std::vector<Wrapland::Server::output*>());
+        }
+
+        // Drain the sockets so the clients' connection buffers never fill up.
+        display->flush();
+        for (auto& client : clients) {
+            Wrapland::Server::Test::read_available(*client);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(BenchOutputBinds)
+#include "bench_output_binds.moc"
@@ -0,0 +1,114 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include <QtTest>
+
+#include "../../server/compositor.h"
+#include "../../server/display.h"
+#include "../../server/surface.h"
+
+#include "raw_clients.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+constexpr int frame_count{200};
+
+void handle_frame_done(void* /*data*/, wl_callback* callback, uint32_t /*time*/)
+{
+    wl_callback_destroy(callback);
+}
+
+wl_callback_listener const frame_listener = {handle_frame_done};
+
+}
+
+/**
+ * Stress test for the protocol work done on the compositor thread per frame: reading and
+ * dispatching the requests of all clients and flushing the frame events back to them.
+ */
+class BenchProtocolIo : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchFrameProtocolTime_data();
+    void benchFrameProtocolTime();
+};
+
+void BenchProtocolIo::benchFrameProtocolTime_data()
+{
+    QTest::addColumn<int>("clients");
+    QTest::addColumn<int>("damages");
+
+    QTest::newRow("10 clients, 10 damages") << 10 << 10;
+    QTest::newRow("100 clients, 10 damages") << 100 << 10;
+    QTest::newRow("100 clients, 100 damages") << 100 << 100;
+    QTest::newRow("400 clients, 10 damages") << 400 << 10;
+}
+
+void BenchProtocolIo::benchFrameProtocolTime()
+{
+    QFETCH(int, clients);
+    QFETCH(int, damages);
+
+    Wrapland::Server::Test::raise_fd_limit(static_cast<size_t>(clients));
+
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("wrapland-bench-protocol-io-0"));
+    display.start_external_loop();
+    QVERIFY(display.running());
+
+    Wrapland::Server::Compositor compositor(&display);
+    std::vector<Wrapland::Server::Surface*> surfaces;
+    connect(&compositor,
+            &Wrapland::Server::Compositor::surfaceCreated,
+            this,
+            [&surfaces](auto surface) { surfaces.push_back(surface); });
+
+    Wrapland::Server::Test::raw_clients raw_clients;
+    Wrapland::Server::Test::connect_clients(display, static_cast<size_t>(clients), raw_clients);
+    QCOMPARE(surfaces.size(), clients);
+
+    std::chrono::nanoseconds server_time{0};
+
+    for (int frame = 0; frame < frame_count; frame++) {
+        for (auto& client : raw_clients) {
+            for (int i = 0; i < damages; i++) {
+                wl_surface_damage(client->surface, i, i, 10, 10);
+            }
+            auto callback = wl_surface_frame(client->surface);
+            wl_callback_add_listener(callback, &frame_listener, nullptr);
+            wl_surface_commit(client->surface);
+            wl_display_flush(client->display);
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+
+        display.dispatch(Wrapland::Server::dispatch_budget());
+        for (auto surface : surfaces) {
+            surface->frameRendered(frame);
+        }
+        display.flush();
+
+        server_time += std::chrono::steady_clock::now() - start;
+
+        for (auto& client : raw_clients) {
+            Wrapland::Server::Test::read_available(*client);
+        }
+    }
+
+    QTest::setBenchmarkResult(static_cast<qreal>(server_time.count()) / frame_count,
+                              QTest::WalltimeNanoseconds);
+
+    raw_clients.clear();
+    display.dispatch();
+}
+
+QTEST_GUILESS_MAIN(BenchProtocolIo)
+#include "bench_protocol_io.moc"
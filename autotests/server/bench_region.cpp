@@ -0,0 +1,163 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include <QtTest>
+
+#include "../../server/rect_region.h"
+
+#include <random>
+#include <vector>
+
+using Wrapland::Server::rect_region;
+
+namespace
+{
+QRect const surface_rect{0, 0, 1920, 1080};
+constexpr int frames{60};
+
+using trace_t = std::vector<std::vector<QRect>>;
+
+// Scrolled browser content: a new strip at the bottom plus a few repainted widgets per frame.
+trace_t scroll_trace()
+{
+    trace_t trace;
+    for (int frame = 0; frame < frames; frame++) {
+        std::vector<QRect> rects;
+        rects.emplace_back(0, 1080 - 40 - frame % 8, 1900, 40 + frame % 8);
+        rects.emplace_back(1900, 0, 20, 1080);
+        for (int i = 0; i < 6; i++) {
+            rects.emplace_back(100 + i * 250, 200 + (frame * 13 + i * 70) % 700, 200, 30);
+        }
+        trace.push_back(std::move(rects));
+    }
+    return trace;
+}
+
+// Text editing: many small scattered glyph rectangles, some of them overlapping.
+trace_t glyph_trace()
+{
+    std::mt19937 gen(4711);
+    std::uniform_int_distribution<int> pos_x(0, 1900);
+    std::uniform_int_distribution<int> pos_y(0, 1060);
+
+    trace_t trace;
+    for (int frame = 0; frame < frames; frame++) {
+        std::vector<QRect> rects;
+        for (int i = 0; i < 120; i++) {
+            rects.emplace_back(pos_x(gen), pos_y(gen), 9, 18);
+        }
+        trace.push_back(std::move(rects));
+    }
+    return trace;
+}
+
+// Video player: the full video area plus small chrome updates around it.
+trace_t video_trace()
+{
+    trace_t trace;
+    for (int frame = 0; frame < frames; frame++) {
+        std::vector<QRect> rects;
+        rects.emplace_back(0, 40, 1920, 960);
+        rects.emplace_back(20 + frame * 30 % 1800, 1010, 60, 10);
+        rects.emplace_back(1800, 1030, 100, 30);
+        rects.emplace_back(10, 5, 300, 30);
+        trace.push_back(std::move(rects));
+    }
+    return trace;
+}
+
+// Opaque content of the surface subtracted from damage below it.
+std::vector<QRect> opaque_rects()
+{
+    return {QRect(0, 0, 1920, 40), QRect(0, 40, 1900, 1000), QRect(0, 1040, 1920, 40)};
+}
+}
+
+/**
+ * Region work per commit for typical damage patterns. Compare the QRegion and rect_region rows.
+ */
+class BenchRegion : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchDamage_data();
+    void benchDamage();
+};
+
+void BenchRegion::benchDamage_data()
+{
+    QTest::addColumn<int>("kind");
+    QTest::addColumn<bool>("qregion");
+
+    QTest::newRow("scroll qregion") << 0 << true;
+    QTest::newRow("scroll rect_region") << 0 << false;
+    QTest::newRow("glyphs qregion") << 1 << true;
+    QTest::newRow("glyphs rect_region") << 1 << false;
+    QTest::newRow("video qregion") << 2 << true;
+    QTest::newRow("video rect_region") << 2 << false;
+}
+
+void BenchRegion::benchDamage()
+{
+    QFETCH(int, kind);
+    QFETCH(bool, qregion);
+
+    auto const trace = kind == 0 ? scroll_trace() : kind == 1 ? glyph_trace() : video_trace();
+
+    auto const opaque = opaque_rects();
+    QPoint const offset{12, 34};
+
+    QRegion opaque_qregion;
+    for (auto const& rect : opaque) {
+        opaque_qregion += rect;
+    }
+    opaque_qregion.translate(offset);
+
+    // The same operations a commit does: accumulate the damage, clip it to the surface, move it
+    // into the global coordinate space and remove what is covered by opaque surfaces.
+    auto run_qregion = [&](auto const& rects) {
+        QRegion damage;
+        for (auto const& rect : rects) {
+            damage += rect;
+        }
+        damage &= surface_rect;
+        damage.translate(offset);
+        return damage.subtracted(opaque_qregion);
+    };
+
+    if (qregion) {
+        QRegion result;
+        QBENCHMARK
+        {
+            for (auto const& rects : trace) {
+                result = run_qregion(rects);
+            }
+        }
+        QCOMPARE(result, run_qregion(trace.back()));
+        return;
+    }
+
+    auto opaque_region = rect_region::from_rects(opaque);
+    opaque_region.translate(offset);
+
+    rect_region result;
+    QBENCHMARK
+    {
+        for (auto const& rects : trace) {
+            rect_region damage;
+            for (auto const& rect : rects) {
+                damage.unite(rect);
+            }
+            damage.intersect(surface_rect);
+            damage.translate(offset);
+            damage.subtract(opaque_region);
+            result = damage;
+        }
+    }
+    QCOMPARE(result.to_qregion(), run_qregion(trace.back()));
+}
+
+QTEST_GUILESS_MAIN(BenchRegion)
+#include "bench_region.moc"
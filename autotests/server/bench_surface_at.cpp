@@ -0,0 +1,207 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include <QtTest>
+
+#include "../../server/compositor.h"
+#include "../../server/display.h"
+#include "../../server/subcompositor.h"
+#include "../../server/surface.h"
+
+#include "raw_clients.h"
+
+#include <cmath>
+#include <random>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+constexpr int branches{16};
+constexpr int depth{4};
+constexpr int picks{1000};
+
+QSize const root_size{1024, 768};
+QSize const child_size{128, 128};
+
+using Wrapland::Server::Surface;
+
+// What compositors do without the index: walk the children recursively from the top.
+Surface* walk(Surface* surface, QPoint const& pixel, QPoint const& offset)
+{
+    auto const& state = surface->state();
+    for (auto it = state.children.crbegin(); it != state.children.crend(); it++) {
+        auto child = (*it)->surface();
+        if (!child || !child->isMapped()) {
+            continue;
+        }
+        if (auto hit = walk(child, pixel, offset + (*it)->position())) {
+            return hit;
+        }
+    }
+
+    auto const local = pixel - offset;
+    if (!QRect(QPoint(), surface->size()).contains(local)) {
+        return nullptr;
+    }
+    return state.input_is_infinite || state.input.contains(local) ? surface : nullptr;
+}
+}
+
+/**
+ * Picking the surface under the pointer in a deep subsurface tree. One iteration picks the surfaces
+ * at a thousand positions, as many as a 1000 Hz pointer reports per second.
+ */
+class BenchSurfaceAt : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchSurfaceAt_data();
+    void benchSurfaceAt();
+};
+
+void BenchSurfaceAt::benchSurfaceAt_data()
+{
+    QTest::addColumn<bool>("index");
+
+    QTest::newRow("index") << true;
+    QTest::newRow("recursive walk") << false;
+}
+
+void BenchSurfaceAt::benchSurfaceAt()
+{
+    QFETCH(bool, index);
+
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("wrapland-bench-surface-at-0"));
+    display.start_external_loop();
+    QVERIFY(display.running());
+
+    Wrapland::Server::Compositor compositor(&display);
+    Wrapland::Server::Subcompositor subcompositor(&display);
+
+    std::vector<Surface*> surfaces;
+    QObject::connect(&compositor,
+                     &Wrapland::Server::Compositor::surfaceCreated,
+                     &compositor,
+                     [&](auto surface) { surfaces.push_back(surface); });
+
+    Wrapland::Server::Test::raw_clients clients;
+    Wrapland::Server::Test::connect_clients(display, 1, clients);
+
+    auto& client = *clients.front();
+    QVERIFY(client.shm);
+    QVERIFY(client.subcompositor);
+
+    // One buffer for the root and one shared by all subsurfaces.
+    auto const root_bytes = root_size.width() * root_size.height() * 4;
+    auto const child_bytes = child_size.width() * child_size.height() * 4;
+    auto const fd = memfd_create("wrapland-bench", MFD_CLOEXEC);
+    QVERIFY(fd >= 0);
+    QCOMPARE(ftruncate(fd, root_bytes + child_bytes), 0);
+
+    auto pool = wl_shm_create_pool(client.shm, fd, root_bytes + child_bytes);
+    auto root_buffer = wl_shm_pool_create_buffer(pool,
+                                                 0,
+                                                 root_size.width(),
+                                                 root_size.height(),
+                                                 root_size.width() * 4,
+                                                 WL_SHM_FORMAT_ARGB8888);
+    auto child_buffer = wl_shm_pool_create_buffer(pool,
+                                                  root_bytes,
+                                                  child_size.width(),
+                                                  child_size.height(),
+                                                  child_size.width() * 4,
+                                                  WL_SHM_FORMAT_ARGB8888);
+    wl_shm_pool_destroy(pool);
+    close(fd);
+
+    auto input = wl_compositor_create_region(client.compositor);
+    wl_region_add(input, 0, 0, 64, 64);
+    wl_region_add(input, 64, 64, 64, 64);
+
+    // Overlapping chains of nested subsurfaces. Every second one has an input region.
+    std::vector<wl_surface*> children;
+    for (int branch = 0; branch < branches; branch++) {
+        auto parent = client.surface;
+        for (int level = 0; level < depth; level++) {
+            auto child = wl_compositor_create_surface(client.compositor);
+            auto subsurface = wl_subcompositor_get_subsurface(client.subcompositor, child, parent);
+            wl_subsurface_set_desync(subsurface);
+
+            auto const pos
+                = level == 0 ? QPoint(branch % 4 * 230, branch / 4 * 170) : QPoint(30, 20);
+            wl_subsurface_set_position(subsurface, pos.x(), pos.y());
+
+            wl_surface_attach(child, child_buffer, 0, 0);
+            if (level % 2 == 1) {
+                wl_surface_set_input_region(child, input);
+            }
+            children.push_back(child);
+            parent = child;
+        }
+    }
+
+    // Commit the deepest surfaces first, so every parent commit applies mapped children.
+    for (auto it = children.crbegin(); it != children.crend(); it++) {
+        wl_surface_commit(*it);
+    }
+    wl_surface_attach(client.surface, root_buffer, 0, 0);
+    wl_surface_commit(client.surface);
+
+    Wrapland::Server::Test::sync_clients(display, clients);
+    QCOMPARE(surfaces.size(), static_cast<size_t>(branches * depth + 1));
+
+    auto const root = surfaces.front();
+    QVERIFY(root->isMapped());
+    QVERIFY(surfaces.back()->isMapped());
+
+    std::mt19937 gen(1000);
+    std::uniform_real_distribution<double> pos_x(-20, root_size.width() + 20);
+    std::uniform_real_distribution<double> pos_y(-20, root_size.height() + 20);
+
+    std::vector<QPointF> positions;
+    for (int i = 0; i < picks; i++) {
+        positions.emplace_back(pos_x(gen), pos_y(gen));
+    }
+
+    auto pick_walk = [&](QPointF const& pos) {
+        auto const pixel = QPoint(static_cast<int>(std::floor(pos.x())),
+                                  static_cast<int>(std::floor(pos.y())));
+        return walk(root, pixel, QPoint());
+    };
+
+    // Both ways pick the same surfaces.
+    for (auto const& pos : positions) {
+        QCOMPARE(root->surface_at(pos).surface, pick_walk(pos));
+    }
+
+    Surface* picked{nullptr};
+    if (index) {
+        QBENCHMARK
+        {
+            for (auto const& pos : positions) {
+                picked = root->surface_at(pos).surface;
+            }
+        }
+    } else {
+        QBENCHMARK
+        {
+            for (auto const& pos : positions) {
+                picked = pick_walk(pos);
+            }
+        }
+    }
+    QCOMPARE(picked, pick_walk(positions.back()));
+
+    wl_region_destroy(input);
+    wl_buffer_destroy(root_buffer);
+    wl_buffer_destroy(child_buffer);
+    clients.clear();
+    display.dispatch();
+}
+
+QTEST_GUILESS_MAIN(BenchSurfaceAt)
+#include "bench_surface_at.moc"
@@ -0,0 +1,184 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include <QtTest>
+
+#include "../../server/compositor.h"
+#include "../../server/display.h"
+#include "../../server/subcompositor.h"
+#include "../../server/surface.h"
+
+#include "raw_clients.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+constexpr int warmup_frames{20};
+constexpr int frames{200};
+constexpr int width{64};
+constexpr int height{64};
+
+std::atomic<bool> counting{false};
+std::atomic<size_t> allocation_count{0};
+std::atomic<size_t> allocated_bytes{0};
+}
+
+// Counts the heap allocations done while the server dispatches the commits.
+void* operator new(std::size_t size)
+{
+    if (counting) {
+        allocation_count++;
+        allocated_bytes += size;
+    }
+    if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+/**
+ * Heap memory the server allocates per commit of a new buffer with damage and a frame callback.
+ * Allocations by libwayland for the callback resources are not included. Fails when the server
+ * allocates on most commits.
+ */
+class BenchSurfaceCommit : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchCommit_data();
+    void benchCommit();
+};
+
+void BenchSurfaceCommit::benchCommit_data()
+{
+    QTest::addColumn<bool>("synchronized");
+
+    QTest::newRow("surface") << false;
+    QTest::newRow("synchronized subsurface") << true;
+}
+
+void BenchSurfaceCommit::benchCommit()
+{
+    QFETCH(bool, synchronized);
+
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("wrapland-bench-surface-commit-0"));
+    display.start_external_loop();
+    QVERIFY(display.running());
+
+    Wrapland::Server::Compositor compositor(&display);
+    Wrapland::Server::Subcompositor subcompositor(&display);
+
+    std::vector<Wrapland::Server::Surface*> surfaces;
+    QObject::connect(&compositor,
+                     &Wrapland::Server::Compositor::surfaceCreated,
+                     &compositor,
+                     [&](auto surface) { surfaces.push_back(surface); });
+
+    Wrapland::Server::Test::raw_clients clients;
+    Wrapland::Server::Test::connect_clients(display, 1, clients);
+
+    auto& client = *clients.front();
+    QVERIFY(client.shm);
+    QVERIFY(client.subcompositor);
+
+    auto surface = client.surface;
+    if (synchronized) {
+        surface = wl_compositor_create_surface(client.compositor);
+        wl_subcompositor_get_subsurface(client.subcompositor, surface, client.surface);
+    }
+
+    // Two buffers the client alternates between.
+    auto const stride = width * 4;
+    auto const size = stride * height;
+    auto const fd = memfd_create("wrapland-bench", MFD_CLOEXEC);
+    QVERIFY(fd >= 0);
+    QCOMPARE(ftruncate(fd, 2 * size), 0);
+
+    auto pool = wl_shm_create_pool(client.shm, fd, 2 * size);
+    wl_buffer* buffers[2];
+    for (int i = 0; i < 2; i++) {
+        buffers[i] = wl_shm_pool_create_buffer(
+            pool, i * size, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+    }
+    wl_shm_pool_destroy(pool);
+    close(fd);
+
+    Wrapland::Server::Test::sync_clients(display, clients);
+    QVERIFY(!surfaces.empty());
+    auto const server_root = surfaces.front();
+
+    auto commit_frame = [&](int frame) {
+        wl_surface_attach(surface, buffers[frame % 2], 0, 0);
+        wl_surface_damage(surface, 0, 0, width, height);
+        wl_callback_destroy(wl_surface_frame(surface));
+        wl_surface_commit(surface);
+        if (synchronized) {
+            wl_surface_commit(client.surface);
+        }
+        wl_display_flush(client.display);
+    };
+
+    auto present = [&](int frame) {
+        server_root->frameRendered(frame);
+        display.flush();
+        Wrapland::Server::Test::read_available(client);
+    };
+
+    for (int frame = 0; frame < warmup_frames; frame++) {
+        commit_frame(frame);
+        display.dispatch();
+        present(frame);
+    }
+
+    allocation_count = 0;
+    allocated_bytes = 0;
+
+    for (int frame = 0; frame < frames; frame++) {
+        commit_frame(frame);
+
+        counting = true;
+        display.dispatch();
+        counting = false;
+
+        present(frame);
+    }
+
+    QVERIFY(surfaces.back()->state().buffer);
+    QCOMPARE(surfaces.back()->state().damage, QRegion(0, 0, width, height));
+
+    // Steady-state commits reuse the surface state. Allow a few stray allocations, for example a
+    // container growing once, but not one per commit.
+    QVERIFY2(allocation_count * 10 < static_cast<size_t>(frames),
+             qPrintable(QStringLiteral("%1 allocations in %2 commits")
+                            .arg(allocation_count.load())
+                            .arg(frames)));
+
+    QTest::setBenchmarkResult(static_cast<qreal>(allocated_bytes) / frames,
+                              QTest::BytesAllocated);
+
+    wl_buffer_destroy(buffers[0]);
+    wl_buffer_destroy(buffers[1]);
+    clients.clear();
+    display.dispatch();
+}
+
+QTEST_GUILESS_MAIN(BenchSurfaceCommit)
+#include "bench_surface_commit.moc"
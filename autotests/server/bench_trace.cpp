@@ -0,0 +1,82 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include <QtTest>
+
+#include "../../server/compositor.h"
+#include "../../server/display.h"
+#include "../../server/surface.h"
+
+#include "raw_clients.h"
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+constexpr size_t client_count{50};
+constexpr int damages{20};
+}
+
+/**
+ * Overhead of the always-on protocol trace. Compare the rows with recording on and off.
+ */
+class BenchTrace : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchDispatch_data();
+    void benchDispatch();
+};
+
+void BenchTrace::benchDispatch_data()
+{
+    QTest::addColumn<size_t>("capacity");
+
+    QTest::newRow("trace off") << size_t{0};
+    QTest::newRow("trace on") << size_t{8192};
+}
+
+void BenchTrace::benchDispatch()
+{
+    QFETCH(size_t, capacity);
+
+    Wrapland::Server::Test::raise_fd_limit(client_count);
+
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("wrapland-bench-trace-0"));
+    display.start_external_loop();
+    QVERIFY(display.running());
+    display.set_trace_capacity(capacity);
+
+    Wrapland::Server::Compositor compositor(&display);
+
+    Wrapland::Server::Test::raw_clients clients;
+    Wrapland::Server::Test::connect_clients(display, client_count, clients);
+
+    QBENCHMARK
+    {
+        for (auto& client : clients) {
+            for (int i = 0; i < damages; i++) {
+                wl_surface_damage(client->surface, i, i, 10, 10);
+            }
+            wl_surface_commit(client->surface);
+            wl_display_flush(client->display);
+        }
+
+        display.dispatch(Wrapland::Server::dispatch_budget());
+        display.flush();
+    }
+
+    if (capacity > 0) {
+        QVERIFY(display.dump_trace().find("wl_surface.damage") != std::string::npos);
+    }
+
+    clients.clear();
+    display.dispatch();
+}
+
+QTEST_GUILESS_MAIN(BenchTrace)
+#include "bench_trace.moc"
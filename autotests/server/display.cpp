@@ -25,6 +25,9 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "../../server/output_manager.h"
 #include "../../server/wl_output.h"
 
+#include <algorithm>
+#include <array>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -41,6 +44,11 @@ private Q_SLOTS:
     void testClientConnection();
     void testConnectNoSocket();
     void testAutoSocketName();
+    void testFlushDirtyClients();
+    void testSlowClient();
+    void testExternalLoop();
+    void testProtocolStats();
+    void testTrace();
 };
 
 void TestServerDisplay::init()
@@ -189,6 +197,9 @@ void TestServerDisplay::testClientConnection()
     QVERIFY(disconnectedSpy.isEmpty());
     wl_client_destroy(wlClient);
     QCOMPARE(disconnectedSpy.count(), 1);
+    QCOMPARE(display.clients().size(), 1);
+    QCOMPARE(display.clients()[0], client2);
+    QCOMPARE(display.getClient(client2->native()), client2);
     QSignalSpy clientDestroyedSpy(client2, &QObject::destroyed);
     QVERIFY(clientDestroyedSpy.isValid());
     client2->destroy();
@@ -236,5 +247,343 @@ void TestServerDisplay::testAutoSocketName()
     QCOMPARE(display1.socket_name(), std::string("wayland-1"));
 }
 
+void TestServerDisplay::testFlushDirtyClients()
+{
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("kwin-wayland-server-display-test-flush-0"));
+    display.start();
+    QVERIFY(display.running());
+
+    int sv[2];
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) >= 0);
+    auto client1 = display.createClient(sv[0]);
+    QVERIFY(client1);
+
+    int sv2[2];
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, sv2) >= 0);
+    auto client2 = display.createClient(sv2[0]);
+    QVERIFY(client2);
+
+    auto has_data = [](int fd) {
+        char buf[64];
+        return recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0;
+    };
+
+    display.flush();
+    auto stats = display.get_client_flush_stats();
+    QCOMPARE(stats.clients_flushed, 0);
+    QCOMPARE(stats.clients_skipped, 2);
+
+    // Queue an event for the first client only.
+    auto callback = wl_resource_create(client1->native(), &wl_callback_interface, 1, 0);
+    QVERIFY(callback);
+    wl_callback_send_done(callback, 42);
+    QVERIFY(!has_data(sv[1]));
+
+    display.flush();
+    stats = display.get_client_flush_stats();
+    QCOMPARE(stats.flushes, 2);
+    QCOMPARE(stats.clients_flushed, 1);
+    QCOMPARE(stats.clients_skipped, 3);
+    QCOMPARE(stats.full_flushes, 0);
+    QVERIFY(has_data(sv[1]));
+    QVERIFY(!has_data(sv2[1]));
+
+    // Nothing new queued.
+    display.flush();
+    stats = display.get_client_flush_stats();
+    QCOMPARE(stats.clients_flushed, 1);
+    QCOMPARE(stats.clients_skipped, 5);
+
+    // A client destroyed with events queued is not flushed anymore.
+    wl_callback_send_done(callback, 43);
+    wl_resource_destroy(callback);
+    wl_client_destroy(client1->native());
+
+    display.flush();
+    stats = display.get_client_flush_stats();
+    QCOMPARE(stats.clients_flushed, 1);
+    QCOMPARE(stats.clients_skipped, 6);
+
+    wl_client_destroy(client2->native());
+    close(sv[0]);
+    close(sv[1]);
+    close(sv2[0]);
+    close(sv2[1]);
+}
+
+void TestServerDisplay::testSlowClient()
+{
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("kwin-wayland-server-display-test-slow-client-0"));
+    QCOMPARE(display.client_buffer_limit(), 0);
+    display.set_client_buffer_limit(1 << 16);
+    QCOMPARE(display.client_buffer_limit(), 1 << 16);
+    display.start();
+    QVERIFY(display.running());
+
+    int sv[2];
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) >= 0);
+
+    // Let the socket fill up quickly.
+    int const sndbuf{4096};
+    QVERIFY(setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)) == 0);
+
+    auto client = display.createClient(sv[0]);
+    QVERIFY(client);
+
+    auto callback = wl_resource_create(client->native(), &wl_callback_interface, 1, 0);
+    QVERIFY(callback);
+
+    // The client does not read. Queue events in small batches until its socket is full.
+    for (int batch = 0; batch < 10000; batch++) {
+        for (int i = 0; i < 10; i++) {
+            wl_callback_send_done(callback, i);
+        }
+        display.flush();
+        if (display.get_client_flush_stats().congestions > 0) {
+            break;
+        }
+    }
+
+    auto stats = display.get_client_flush_stats();
+    QCOMPARE(stats.congestions, 1);
+    QCOMPARE(stats.events_deferred, 0);
+    QCOMPARE(stats.events_replaced, 0);
+
+    // Still congested, the client is not counted again.
+    display.flush();
+    QCOMPARE(display.get_client_flush_stats().congestions, 1);
+
+    // The client reads everything. Its buffer drains once the event loop reports the socket
+    // writable.
+    std::array<char, 4096> events{};
+    for (int i = 0; i < 3; i++) {
+        while (recv(sv[1], events.data(), events.size(), MSG_DONTWAIT) > 0) {
+        }
+        display.dispatch();
+        display.flush();
+    }
+
+    // Being slow again is counted anew.
+    for (int batch = 0; batch < 10000; batch++) {
+        for (int i = 0; i < 10; i++) {
+            wl_callback_send_done(callback, i);
+        }
+        display.flush();
+        if (display.get_client_flush_stats().congestions > 1) {
+            break;
+        }
+    }
+    QCOMPARE(display.get_client_flush_stats().congestions, 2);
+
+    wl_resource_destroy(callback);
+    wl_client_destroy(client->native());
+    close(sv[0]);
+    close(sv[1]);
+}
+
+void TestServerDisplay::testExternalLoop()
+{
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("kwin-wayland-server-display-test-external-loop-0"));
+    QSignalSpy startedSpy(&display, &Wrapland::Server::Display::started);
+    QVERIFY(startedSpy.isValid());
+    QCOMPARE(display.event_loop_fd(), -1);
+
+    display.start_external_loop();
+    QVERIFY(display.running());
+    QCOMPARE(startedSpy.count(), 1);
+
+    auto const fd = display.event_loop_fd();
+    QVERIFY(fd >= 0);
+
+    int sv[2];
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) >= 0);
+    auto client = display.createClient(sv[0]);
+    QVERIFY(client);
+
+    auto is_readable = [](int fd) {
+        pollfd pfd{fd, POLLIN, 0};
+        return poll(&pfd, 1, 0) > 0;
+    };
+    QVERIFY(!is_readable(fd));
+
+    // Raw wl_display.sync requests with new ids 2 to 4.
+    std::array<uint32_t, 9> requests{};
+    for (uint32_t i = 0; i < 3; i++) {
+        requests.at(i * 3) = 1;
+        requests.at(i * 3 + 1) = 12 << 16;
+        requests.at(i * 3 + 2) = i + 2;
+    }
+    auto const size = static_cast<ssize_t>(sizeof(requests));
+    QCOMPARE(send(sv[1], requests.data(), sizeof(requests), 0), size);
+    QVERIFY(is_readable(fd));
+
+    Wrapland::Server::dispatch_budget budget;
+    budget.requests = 1;
+    budget.time = std::chrono::milliseconds(10);
+    QVERIFY(!display.dispatch(budget));
+    QVERIFY(!is_readable(fd));
+    QVERIFY(!is_readable(sv[1]));
+
+    // Callback done and delete_id events for all three requests.
+    display.flush();
+    QVERIFY(is_readable(sv[1]));
+    std::array<char, 256> events{};
+    QCOMPARE(recv(sv[1], events.data(), events.size(), MSG_DONTWAIT), 3 * (12 + 12));
+
+    wl_client_destroy(client->native());
+    close(sv[0]);
+    close(sv[1]);
+}
+
+void TestServerDisplay::testProtocolStats()
+{
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("kwin-wayland-server-display-test-protocol-stats-0"));
+    display.start_external_loop();
+    QVERIFY(display.running());
+    QVERIFY(!display.protocol_stats_enabled());
+
+    int sv[2];
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) >= 0);
+    auto client = display.createClient(sv[0]);
+    QVERIFY(client);
+
+    auto send_syncs = [&](uint32_t first_id) {
+        std::array<uint32_t, 6> requests{1, 12 << 16, first_id, 1, 12 << 16, first_id + 1};
+        auto const size = static_cast<ssize_t>(sizeof(requests));
+        QCOMPARE(send(sv[1], requests.data(), sizeof(requests), 0), size);
+        display.dispatch();
+        display.flush();
+
+        std::array<char, 256> events{};
+        QCOMPARE(recv(sv[1], events.data(), events.size(), MSG_DONTWAIT), 2 * (12 + 12));
+    };
+
+    // Nothing is recorded while disabled.
+    send_syncs(2);
+    QVERIFY(client->protocol_stats().empty());
+
+    display.set_protocol_stats_enabled(true);
+    QVERIFY(display.protocol_stats_enabled());
+    send_syncs(2);
+
+    auto find_entry = [&client](std::string const& interface, std::string const& message) {
+        auto const stats = client->protocol_stats();
+        auto it = std::find_if(stats.cbegin(), stats.cend(), [&](auto const& entry) {
+            return entry.interface == interface && entry.message == message;
+        });
+        return it == stats.cend() ? Wrapland::Server::protocol_stats_entry() : *it;
+    };
+
+    QCOMPARE(client->protocol_stats().size(), 3);
+
+    auto sync = find_entry("wl_display", "sync");
+    QVERIFY(sync.is_request);
+    QCOMPARE(sync.opcode, 0);
+    QCOMPARE(sync.count, 2);
+    QCOMPARE(sync.bytes, 24);
+    QVERIFY(sync.dispatch_time.count() > 0);
+
+    auto done = find_entry("wl_callback", "done");
+    QVERIFY(!done.is_request);
+    QCOMPARE(done.count, 2);
+    QCOMPARE(done.bytes, 24);
+    QCOMPARE(done.dispatch_time.count(), 0);
+
+    auto delete_id = find_entry("wl_display", "delete_id");
+    QVERIFY(!delete_id.is_request);
+    QCOMPARE(delete_id.opcode, 1);
+    QCOMPARE(delete_id.count, 2);
+
+    client->reset_protocol_stats();
+    QVERIFY(client->protocol_stats().empty());
+
+    send_syncs(2);
+    QCOMPARE(find_entry("wl_display", "sync").count, 2);
+
+    display.reset_protocol_stats();
+    QVERIFY(client->protocol_stats().empty());
+
+    wl_client_destroy(client->native());
+    close(sv[0]);
+    close(sv[1]);
+}
+
+void TestServerDisplay::testTrace()
+{
+    Wrapland::Server::Display display;
+    display.set_socket_name(std::string("kwin-wayland-server-display-test-trace-0"));
+    display.start_external_loop();
+    QVERIFY(display.running());
+    QVERIFY(display.trace_capacity() > 0);
+
+    int sv[2];
+    QVERIFY(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) >= 0);
+    auto client = display.createClient(sv[0]);
+    QVERIFY(client);
+
+    std::array<uint32_t, 3> request{1, 12 << 16, 2};
+    auto const size = static_cast<ssize_t>(sizeof(request));
+    QCOMPARE(send(sv[1], request.data(), sizeof(request), 0), size);
+    display.dispatch();
+    display.flush();
+
+    auto parse = [&display] {
+        auto const dump = display.dump_trace();
+        QJsonParseError error;
+        auto doc = QJsonDocument::fromJson(QByteArray::fromStdString(dump), &error);
+        return doc.object().value(QStringLiteral("traceEvents")).toArray();
+    };
+
+    auto events = parse();
+    QCOMPARE(events.size(), 4);
+
+    auto sync = events.at(0).toObject();
+    QCOMPARE(sync.value(QStringLiteral("name")).toString(), QStringLiteral("wl_display.sync"));
+    QCOMPARE(sync.value(QStringLiteral("cat")).toString(), QStringLiteral("request"));
+    QCOMPARE(sync.value(QStringLiteral("pid")).toInt(), static_cast<int>(client->processId()));
+
+    auto done = events.at(1).toObject();
+    QCOMPARE(done.value(QStringLiteral("name")).toString(), QStringLiteral("wl_callback.done"));
+    QCOMPARE(done.value(QStringLiteral("cat")).toString(), QStringLiteral("event"));
+    QCOMPARE(done.value(QStringLiteral("args")).toObject().value(QStringLiteral("id")).toInt(), 2);
+
+    QCOMPARE(events.at(2).toObject().value(QStringLiteral("name")).toString(),
+             QStringLiteral("wl_display.delete_id"));
+
+    auto flush = events.at(3).toObject();
+    QCOMPARE(flush.value(QStringLiteral("cat")).toString(), QStringLiteral("flush"));
+    QCOMPARE(flush.value(QStringLiteral("ph")).toString(), QStringLiteral("X"));
+    QCOMPARE(flush.value(QStringLiteral("pid")).toInt(), static_cast<int>(getpid()));
+
+    // The ring keeps only the most recent records.
+    display.set_trace_capacity(3);
+    QCOMPARE(display.trace_capacity(), 4);
+    QVERIFY(parse().isEmpty());
+
+    for (int i = 0; i < 2; i++) {
+        QCOMPARE(send(sv[1], request.data(), sizeof(request), 0), size);
+        display.dispatch();
+        display.flush();
+    }
+    events = parse();
+    QCOMPARE(events.size(), 4);
+    QCOMPARE(events.at(0).toObject().value(QStringLiteral("name")).toString(),
+             QStringLiteral("wl_display.sync"));
+
+    display.set_trace_capacity(0);
+    QCOMPARE(send(sv[1], request.data(), sizeof(request), 0), size);
+    display.dispatch();
+    display.flush();
+    QVERIFY(parse().isEmpty());
+
+    wl_client_destroy(client->native());
+    close(sv[0]);
+    close(sv[1]);
+}
+
 QTEST_GUILESS_MAIN(TestServerDisplay)
 #include "display.moc"
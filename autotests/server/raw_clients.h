@@ -0,0 +1,194 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include <QtTest>
+
+#include "../../server/display.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <vector>
+#include <wayland-client-protocol.h>
+
+/**
+ * Plain libwayland clients living in the test process for benchmarks with many connections. The
+ * server is driven from the same thread, so nothing here blocks.
+ */
+namespace Wrapland::Server::Test
+{
+
+struct raw_client {
+    raw_client() = default;
+    raw_client(raw_client const&) = delete;
+    raw_client& operator=(raw_client const&) = delete;
+    raw_client(raw_client&&) noexcept = delete;
+    raw_client& operator=(raw_client&&) noexcept = delete;
+
+    ~raw_client()
+    {
+        if (display) {
+            wl_display_disconnect(display);
+        }
+    }
+
+    wl_display* display{nullptr};
+    wl_registry* registry{nullptr};
+    wl_compositor* compositor{nullptr};
+    wl_subcompositor* subcompositor{nullptr};
+    wl_shm* shm{nullptr};
+    std::vector<wl_output*> outputs;
+    wl_surface* surface{nullptr};
+
+    bool synced{false};
+    int entered{0};
+};
+
+using raw_clients = std::vector<std::unique_ptr<raw_client>>;
+
+namespace raw_detail
+{
+
+inline void handle_global(void* data,
+                          wl_registry* registry,
+                          uint32_t name,
+                          char const* interface,
+                          uint32_t /*version*/)
+{
+    auto client = static_cast<raw_client*>(data);
+
+    if (std::strcmp(interface, wl_compositor_interface.name) == 0) {
+        client->compositor = static_cast<wl_compositor*>(
+            wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+    } else if (std::strcmp(interface, wl_subcompositor_interface.name) == 0) {
+        client->subcompositor = static_cast<wl_subcompositor*>(
+            wl_registry_bind(registry, name, &wl_subcompositor_interface, 1));
+    } else if (std::strcmp(interface, wl_shm_interface.name) == 0) {
+        client->shm = static_cast<wl_shm*>(wl_registry_bind(registry, name, &wl_shm_interface, 1));
+    } else if (std::strcmp(interface, wl_output_interface.name) == 0) {
+        client->outputs.push_back(
+            static_cast<wl_output*>(wl_registry_bind(registry, name, &wl_output_interface, 1)));
+    }
+}
+
+inline void handle_global_remove(void* /*data*/, wl_registry* /*registry*/, uint32_t /*name*/)
+{
+}
+
+inline wl_registry_listener const registry_listener = {handle_global, handle_global_remove};
+
+inline void handle_enter(void* data, wl_surface* /*surface*/, wl_output* /*output*/)
+{
+    static_cast<raw_client*>(data)->entered++;
+}
+
+inline void handle_leave(void* data, wl_surface* /*surface*/, wl_output* /*output*/)
+{
+    static_cast<raw_client*>(data)->entered--;
+}
+
+inline wl_surface_listener const surface_listener = {handle_enter, handle_leave};
+
+inline void handle_sync_done(void* data, wl_callback* callback, uint32_t /*serial*/)
+{
+    static_cast<raw_client*>(data)->synced = true;
+    wl_callback_destroy(callback);
+}
+
+inline wl_callback_listener const sync_listener = {handle_sync_done};
+
+}
+
+/// Both ends of every connection live in this process.
+inline void raise_fd_limit(size_t client_count)
+{
+    rlimit limit;
+    QVERIFY(getrlimit(RLIMIT_NOFILE, &limit) == 0);
+    if (limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        QVERIFY(setrlimit(RLIMIT_NOFILE, &limit) == 0);
+    }
+    QVERIFY(limit.rlim_cur > 2 * client_count + 64);
+}
+
+/// Reads and dispatches whatever the server has sent to the client without blocking.
+inline void read_available(raw_client& client)
+{
+    while (wl_display_prepare_read(client.display) != 0) {
+        wl_display_dispatch_pending(client.display);
+    }
+
+    pollfd pfd{wl_display_get_fd(client.display), POLLIN, 0};
+    if (poll(&pfd, 1, 0) > 0) {
+        wl_display_read_events(client.display);
+    } else {
+        wl_display_cancel_read(client.display);
+    }
+    wl_display_dispatch_pending(client.display);
+}
+
+/// Round-trips all clients while driving the server.
+inline void sync_clients(Server::Display& display, raw_clients& clients)
+{
+    for (auto& client : clients) {
+        client->synced = false;
+        auto callback = wl_display_sync(client->display);
+        wl_callback_add_listener(callback, &raw_detail::sync_listener, client.get());
+        wl_display_flush(client->display);
+    }
+
+    auto all_synced = [&clients] {
+        return std::all_of(
+            clients.cbegin(), clients.cend(), [](auto const& client) { return client->synced; });
+    };
+
+    while (!all_synced()) {
+        display.dispatch();
+        display.flush();
+        for (auto& client : clients) {
+            if (!client->synced) {
+                read_available(*client);
+            }
+        }
+    }
+}
+
+/**
+ * Connects @arg count clients. Each binds the compositor, the subcompositor and all outputs and
+ * creates one surface.
+ */
+inline void connect_clients(Server::Display& display, size_t count, raw_clients& clients)
+{
+    for (size_t i = 0; i < count; i++) {
+        int sv[2];
+        QVERIFY(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) >= 0);
+        QVERIFY(display.createClient(sv[0]));
+
+        auto client = std::make_unique<raw_client>();
+        client->display = wl_display_connect_to_fd(sv[1]);
+        QVERIFY(client->display);
+
+        client->registry = wl_display_get_registry(client->display);
+        wl_registry_add_listener(client->registry, &raw_detail::registry_listener, client.get());
+        clients.push_back(std::move(client));
+    }
+
+    sync_clients(display, clients);
+
+    for (auto& client : clients) {
+        QVERIFY(client->compositor);
+        client->surface = wl_compositor_create_surface(client->compositor);
+        wl_surface_add_listener(client->surface, &raw_detail::surface_listener, client.get());
+    }
+
+    sync_clients(display, clients);
+}
+
+}
@@ -0,0 +1,281 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include <QtTest>
+
+#include "../../server/buffer_mapping.h"
+#include "../../server/damage_list.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using Wrapland::Server::buffer_mapping;
+using Wrapland::Server::output_transform;
+
+Q_DECLARE_METATYPE(Wrapland::Server::output_transform)
+
+namespace
+{
+
+QSize const buffer_size{12, 6};
+
+bool swaps_axes(output_transform transform)
+{
+    return transform == output_transform::rotated_90 || transform == output_transform::rotated_270
+        || transform == output_transform::flipped_90 || transform == output_transform::flipped_270;
+}
+
+// Buffer pixel a renderer samples for pixel (u, v) of the buffer with its transform undone.
+QPoint sample(output_transform transform, int u, int v)
+{
+    auto const width = buffer_size.width();
+    auto const height = buffer_size.height();
+
+    switch (transform) {
+    case output_transform::normal:
+        return {u, v};
+    case output_transform::rotated_90:
+        return {width - 1 - v, u};
+    case output_transform::rotated_180:
+        return {width - 1 - u, height - 1 - v};
+    case output_transform::rotated_270:
+        return {v, height - 1 - u};
+    case output_transform::flipped:
+        return {width - 1 - u, v};
+    case output_transform::flipped_90:
+        return {width - 1 - v, height - 1 - u};
+    case output_transform::flipped_180:
+        return {u, height - 1 - v};
+    case output_transform::flipped_270:
+        return {v, u};
+    }
+    return {};
+}
+
+/**
+ * Reference for a single surface pixel: it needs a repaint when any buffer pixel in its footprint
+ * is damaged. The footprint is computed backwards from the surface, pixel by pixel.
+ */
+bool reference_damaged(buffer_mapping const& mapping, QRect const& damage, int pos_x, int pos_y)
+{
+    auto const surface_size = mapping.surface_size();
+    if (pos_x < 0 || pos_y < 0 || pos_x >= surface_size.width()
+        || pos_y >= surface_size.height()) {
+        return false;
+    }
+
+    auto const scale = static_cast<double>(mapping.scale);
+    auto const transformed = swaps_axes(mapping.transform) ? buffer_size.transposed() : buffer_size;
+
+    auto const src = mapping.source.isValid()
+        ? mapping.source
+        : QRectF(0, 0, transformed.width() / scale, transformed.height() / scale);
+    auto const dst = mapping.destination.isValid() ? QSizeF(mapping.destination) : src.size();
+
+    // Footprint in buffer pixels with the transform undone.
+    auto const x1 = (src.x() * dst.width() + pos_x * src.width()) * scale / dst.width();
+    auto const x2 = (src.x() * dst.width() + (pos_x + 1) * src.width()) * scale / dst.width();
+    auto const y1 = (src.y() * dst.height() + pos_y * src.height()) * scale / dst.height();
+    auto const y2 = (src.y() * dst.height() + (pos_y + 1) * src.height()) * scale / dst.height();
+
+    for (auto v = static_cast<int>(std::floor(y1)); v < y2; v++) {
+        for (auto u = static_cast<int>(std::floor(x1)); u < x2; u++) {
+            if (u + 1 <= x1 || v + 1 <= y1) {
+                continue;
+            }
+            if (u < 0 || v < 0 || u >= transformed.width() || v >= transformed.height()) {
+                continue;
+            }
+            if (damage.contains(sample(mapping.transform, u, v))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<QRect> damage_rects()
+{
+    std::vector<QRect> rects{
+        QRect(QPoint(), buffer_size),
+        QRect(0, 0, 1, 1),
+        QRect(11, 5, 1, 1),
+        QRect(3, 0, 1, 6),
+        QRect(0, 2, 12, 1),
+        QRect(-4, -4, 6, 6),
+        QRect(10, 4, 8, 8),
+    };
+
+    std::mt19937 gen(815);
+    std::uniform_int_distribution<int> pos_x(-2, buffer_size.width());
+    std::uniform_int_distribution<int> pos_y(-2, buffer_size.height());
+    std::uniform_int_distribution<int> size(1, 7);
+    for (int i = 0; i < 100; i++) {
+        rects.emplace_back(pos_x(gen), pos_y(gen), size(gen), size(gen));
+    }
+    return rects;
+}
+
+}
+
+class TestBufferMapping : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSurfaceSize_data();
+    void testSurfaceSize();
+    void testPixels_data();
+    void testPixels();
+    void testBatch();
+};
+
+void TestBufferMapping::testSurfaceSize_data()
+{
+    QTest::addColumn<output_transform>("transform");
+    QTest::addColumn<int>("scale");
+    QTest::addColumn<QRectF>("source");
+    QTest::addColumn<QSize>("destination");
+    QTest::addColumn<QSize>("expected");
+
+    QTest::newRow("normal") << output_transform::normal << 1 << QRectF() << QSize()
+                            << QSize(12, 6);
+    QTest::newRow("scaled") << output_transform::normal << 2 << QRectF() << QSize()
+                            << QSize(6, 3);
+    QTest::newRow("rotated") << output_transform::rotated_90 << 1 << QRectF() << QSize()
+                             << QSize(6, 12);
+    QTest::newRow("rotated scaled")
+        << output_transform::flipped_270 << 3 << QRectF() << QSize() << QSize(2, 4);
+    QTest::newRow("flipped") << output_transform::flipped_180 << 1 << QRectF() << QSize()
+                             << QSize(12, 6);
+    QTest::newRow("source") << output_transform::rotated_270 << 1 << QRectF(1, 1, 4, 5)
+                            << QSize() << QSize(4, 5);
+    QTest::newRow("destination")
+        << output_transform::rotated_90 << 2 << QRectF() << QSize(30, 20) << QSize(30, 20);
+    QTest::newRow("source and destination")
+        << output_transform::normal << 1 << QRectF(1, 1, 4, 2) << QSize(8, 8) << QSize(8, 8);
+}
+
+void TestBufferMapping::testSurfaceSize()
+{
+    QFETCH(output_transform, transform);
+    QFETCH(int, scale);
+    QFETCH(QRectF, source);
+    QFETCH(QSize, destination);
+
+    buffer_mapping mapping{buffer_size, scale, transform, source, destination};
+    QTEST(mapping.surface_size(), "expected");
+}
+
+void TestBufferMapping::testPixels_data()
+{
+    QTest::addColumn<output_transform>("transform");
+    QTest::addColumn<int>("scale");
+    QTest::addColumn<QRectF>("source");
+    QTest::addColumn<QSize>("destination");
+
+    struct viewport {
+        char const* name;
+        QRectF source;
+        QSize destination;
+    };
+
+    // Sources in surface coordinates fitting into the surface of every transform and scale.
+    std::vector<viewport> const viewports{
+        {"no viewport", QRectF(), QSize()},
+        {"crop", QRectF(0.5, 0.25, 1, 1), QSize()},
+        {"crop and scale up", QRectF(0.5, 0.25, 1.5, 1.25), QSize(7, 5)},
+        {"crop and scale down", QRectF(0, 0.5, 2, 1.5), QSize(1, 1)},
+        {"scale", QRectF(), QSize(9, 9)},
+    };
+
+    std::vector<std::pair<char const*, output_transform>> const transforms{
+        {"normal", output_transform::normal},
+        {"90", output_transform::rotated_90},
+        {"180", output_transform::rotated_180},
+        {"270", output_transform::rotated_270},
+        {"flipped", output_transform::flipped},
+        {"flipped 90", output_transform::flipped_90},
+        {"flipped 180", output_transform::flipped_180},
+        {"flipped 270", output_transform::flipped_270},
+    };
+
+    for (auto const& [transform_name, transform] : transforms) {
+        for (auto scale : {1, 2, 3}) {
+            for (auto const& view : viewports) {
+                auto const name = QByteArray(transform_name) + " scale " + QByteArray::number(scale)
+                    + ", " + view.name;
+                QTest::newRow(name.constData())
+                    << transform << scale << view.source << view.destination;
+            }
+        }
+    }
+}
+
+void TestBufferMapping::testPixels()
+{
+    QFETCH(output_transform, transform);
+    QFETCH(int, scale);
+    QFETCH(QRectF, source);
+    QFETCH(QSize, destination);
+
+    buffer_mapping mapping{buffer_size, scale, transform, source, destination};
+    auto const surface_size = mapping.surface_size();
+
+    for (auto const& damage : damage_rects()) {
+        QRect mapped;
+        auto const count = mapping.map(&damage, 1, &mapped);
+        QVERIFY(count <= 1);
+
+        for (int pos_y = -2; pos_y < surface_size.height() + 2; pos_y++) {
+            for (int pos_x = -2; pos_x < surface_size.width() + 2; pos_x++) {
+                auto const expected = reference_damaged(mapping, damage, pos_x, pos_y);
+                auto const damaged = count == 1 && mapped.contains(pos_x, pos_y);
+                if (damaged != expected) {
+                    qWarning() << "damage" << damage << "mapped" << mapped << "pixel" << pos_x
+                               << pos_y;
+                }
+                QCOMPARE(damaged, expected);
+            }
+        }
+    }
+}
+
+void TestBufferMapping::testBatch()
+{
+    // Mapping a whole list gives the union of the single rectangles. Rectangles outside of the
+    // viewport source are dropped.
+    buffer_mapping mapping{
+        buffer_size, 2, output_transform::rotated_90, QRectF(0.5, 0.5, 2, 4), QSize(4, 8)};
+
+    auto const rects = damage_rects();
+    Wrapland::Server::damage_list damage;
+    for (auto const& rect : rects) {
+        damage.add(rect, 0);
+    }
+
+    std::vector<QRect> mapped(rects.size());
+    auto const count = mapping.map(rects.data(), rects.size(), mapped.data());
+    QVERIFY(count > 0);
+    QVERIFY(count < rects.size());
+
+    QRegion expected;
+    for (auto const& rect : rects) {
+        QRect single;
+        if (mapping.map(&rect, 1, &single) == 1) {
+            expected += single;
+        }
+    }
+
+    QRegion batched;
+    for (size_t i = 0; i < count; i++) {
+        batched += mapped.at(i);
+    }
+    QCOMPARE(batched, expected);
+    QCOMPARE(mapping.map(damage).to_qregion(), expected);
+}
+
+QTEST_GUILESS_MAIN(TestBufferMapping)
+#include "test_buffer_mapping.moc"
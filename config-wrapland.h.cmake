@@ -1 +1,2 @@
 #cmakedefine01 HAVE_LINUX_INPUT_H
+#cmakedefine01 WRAPLAND_USDT
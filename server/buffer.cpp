@@ -27,6 +27,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "wayland/buffer_manager.h"
 #include "wayland/display.h"
+#include "wayland/probes.h"
 
 #include "linux_dmabuf_v1.h"
 #include "linux_dmabuf_v1_p.h"
@@ -198,13 +199,9 @@ std::optional<ShmImage> ShmImage::get(Buffer* buffer)
     return ShmImage(buffer, imageFormat);
 }
 
-Buffer::Private::Private(Buffer* q_ptr,
-                         wl_resource* wlResource,
-                         Surface* surface,
-                         Wayland::Display* display)
+Buffer::Private::Private(Buffer* q_ptr, wl_resource* wlResource, Wayland::Display* display)
     : resource(wlResource)
     , shmBuffer(wl_shm_buffer_get(wlResource))
-    , surface(surface)
     , display(display)
     , q_ptr{q_ptr}
 {
@@ -270,41 +267,54 @@ Buffer::Private::Private(Buffer* q_ptr,
             break;
         }
         size = dmabufBuffer->size;
-    } else if (surface) {
-        EGLDisplay eglDisplay = surface->client()->display()->eglDisplay();
+    } else {
+        probe_egl();
+    }
+}
 
-        using namespace EGL;
-        static eglQueryWaylandBufferWL_func eglQueryWaylandBufferWL{nullptr};
-        static bool resolved{false};
+void Buffer::Private::probe_egl()
+{
+    EGLDisplay eglDisplay = display->eglDisplay;
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        // Try again on a later attach, the compositor might not have set up EGL yet.
+        return;
+    }
 
-        if (!resolved && eglDisplay != EGL_NO_DISPLAY) {
-            eglQueryWaylandBufferWL = reinterpret_cast<eglQueryWaylandBufferWL_func>(
-                eglGetProcAddress("eglQueryWaylandBufferWL"));
-            resolved = true;
-        }
+    using namespace EGL;
+    static eglQueryWaylandBufferWL_func eglQueryWaylandBufferWL{nullptr};
+    static bool resolved{false};
 
-        if (eglQueryWaylandBufferWL) {
-            EGLint width = 0;
-            EGLint height = 0;
-            bool valid = false;
-            valid = eglQueryWaylandBufferWL(eglDisplay, resource, EGL_WIDTH, &width);
-            valid = valid && eglQueryWaylandBufferWL(eglDisplay, resource, EGL_HEIGHT, &height);
-            if (valid) {
-                size = QSize(width, height);
-            }
-            // check alpha
-            EGLint format = 0;
-            if (eglQueryWaylandBufferWL(eglDisplay, resource, EGL_TEXTURE_FORMAT, &format)) {
-                switch (format) {
-                case EGL_TEXTURE_RGBA:
-                    alpha = true;
-                    break;
-                case EGL_TEXTURE_RGB:
-                default:
-                    alpha = false;
-                    break;
-                }
-            }
+    if (!resolved) {
+        eglQueryWaylandBufferWL = reinterpret_cast<eglQueryWaylandBufferWL_func>(
+            eglGetProcAddress("eglQueryWaylandBufferWL"));
+        resolved = true;
+    }
+
+    egl_probed = true;
+
+    if (!eglQueryWaylandBufferWL) {
+        return;
+    }
+
+    EGLint width = 0;
+    EGLint height = 0;
+    bool valid = false;
+    valid = eglQueryWaylandBufferWL(eglDisplay, resource, EGL_WIDTH, &width);
+    valid = valid && eglQueryWaylandBufferWL(eglDisplay, resource, EGL_HEIGHT, &height);
+    if (valid) {
+        size = QSize(width, height);
+    }
+    // check alpha
+    EGLint format = 0;
+    if (eglQueryWaylandBufferWL(eglDisplay, resource, EGL_TEXTURE_FORMAT, &format)) {
+        switch (format) {
+        case EGL_TEXTURE_RGBA:
+            alpha = true;
+            break;
+        case EGL_TEXTURE_RGB:
+        default:
+            alpha = false;
+            break;
         }
     }
 }
@@ -312,15 +322,54 @@ Buffer::Private::Private(Buffer* q_ptr,
 Buffer::Private::~Private()
 {
     wl_list_remove(&destroyWrapper.listener.link);
-    display->bufferManager()->removeBuffer(q_ptr);
+}
+
+std::shared_ptr<Buffer> Buffer::Private::attach(std::shared_ptr<Buffer> const& owner)
+{
+    if (auto current = attachment.lock()) {
+        // Attached again while the previous attachment is still in use. Share it so the client
+        // only receives a single release once the compositor is done with the buffer.
+        return current;
+    }
+
+    if (!shmBuffer && !dmabufBuffer && !egl_probed) {
+        probe_egl();
+    }
+
+    // The attachment keeps the buffer alive but does not own it. Releasing the last reference to
+    // the attachment only releases the wl_buffer back to the client. Buffers are attached every
+    // frame, so the reference's control block comes from a pool.
+    auto ref = std::shared_ptr<Buffer>(owner.get(),
+                                       [owner](Buffer* buffer) { buffer->d_ptr->release(); },
+                                       Wayland::pool_allocator<Buffer>());
+    attachment = ref;
+    return ref;
+}
+
+void Buffer::Private::release()
+{
+    // The weak reference would otherwise keep the attachment's deleter and with it the owner alive.
+    attachment.reset();
+    surface.clear();
+
+    if (committed && resource) {
+        display->bufferManager()->release(resource, immediate_release);
+    }
+    committed = false;
 }
 
 std::shared_ptr<Buffer> Buffer::make(wl_resource* wlResource, Surface* surface)
 {
-    auto backendDisplay = Wayland::Display::backendCast(surface->client()->display());
-    auto buffer = std::shared_ptr<Buffer>{new Buffer(wlResource, surface)};
-    backendDisplay->bufferManager()->addBuffer(buffer);
-    return buffer;
+    auto buffer = get(surface->client()->display(), wlResource);
+    buffer->d_ptr->surface = surface;
+
+    WRAPLAND_PROBE(buffer_make,
+                   surface->client()->processId(),
+                   surface->id(),
+                   wl_resource_get_id(wlResource),
+                   buffer->size().width(),
+                   buffer->size().height());
+    return buffer->d_ptr->attach(buffer);
 }
 
 std::shared_ptr<Buffer> Buffer::make(wl_resource* wlResource, Display* display)
@@ -342,23 +391,17 @@ void Buffer::Private::destroyListenerCallback(wl_listener* listener, [[maybe_unu
     // * modernize-use-auto
     // NOLINTNEXTLINE
     DestroyWrapper* wrapper = wl_container_of(listener, wrapper, listener);
+    auto priv = wrapper->buffer->d_ptr.get();
 
-    wrapper->buffer->d_ptr->resource = nullptr;
+    // The manager holds the owning reference. Keep the buffer alive until we are done here.
+    auto keep_alive = priv->display->bufferManager()->removeBuffer(priv->resource);
+    priv->resource = nullptr;
     Q_EMIT wrapper->buffer->resourceDestroyed();
 }
 
-Buffer::Buffer(wl_resource* wlResource, Surface* surface)
-    : QObject(nullptr)
-    , d_ptr(new Private(this,
-                        wlResource,
-                        surface,
-                        Wayland::Display::backendCast(surface->client()->display())))
-{
-}
-
 Buffer::Buffer(wl_resource* wlResource, Display* display)
     : QObject(nullptr)
-    , d_ptr(new Private(this, wlResource, nullptr, Wayland::Display::backendCast(display)))
+    , d_ptr(new Private(this, wlResource, Wayland::Display::backendCast(display)))
 {
 }
 
@@ -372,12 +415,16 @@ std::shared_ptr<Buffer> Buffer::get(Display* display, wl_resource* resource)
     return buffer ? buffer.value() : make(resource, display);
 }
 
-Buffer::~Buffer()
+Buffer::~Buffer() = default;
+
+void* Buffer::operator new(std::size_t size)
 {
-    if (d_ptr->committed && d_ptr->resource) {
-        wl_buffer_send_release(d_ptr->resource);
-        wl_client_flush(wl_resource_get_client(d_ptr->resource));
-    }
+    return Wayland::object_pool<Buffer>::allocate(size);
+}
+
+void Buffer::operator delete(void* ptr, std::size_t size)
+{
+    Wayland::object_pool<Buffer>::deallocate(ptr, size);
 }
 
 std::optional<ShmImage> Buffer::shmImage()
@@ -420,4 +467,9 @@ void Buffer::setCommitted()
     d_ptr->committed = true;
 }
 
+void Buffer::set_immediate_release(bool immediate)
+{
+    d_ptr->immediate_release = immediate;
+}
+
 }
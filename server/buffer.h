@@ -76,6 +76,12 @@ class WRAPLANDSERVER_EXPORT Buffer : public QObject
 public:
     ~Buffer() override;
 
+    // Clients may create new buffers per frame, they come from a pool.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
+    // The surface the buffer is attached to. With several surfaces, the last one that attached it.
+    // Null once the buffer is released or the surface is destroyed.
     Surface* surface() const;
     wl_shm_buffer* shmBuffer();
     linux_dmabuf_buffer_v1* linuxDmabufBuffer();
@@ -86,6 +92,13 @@ public:
     QSize size() const;
     void setCommitted();
 
+    /**
+     * By default the release of a buffer is queued and sent to the client together with all other
+     * pending events on the next flush of the display. Enable this for latency-critical buffers
+     * to flush the client right away when the buffer is released.
+     */
+    void set_immediate_release(bool immediate);
+
     bool hasAlphaChannel() const;
 
     static std::shared_ptr<Buffer> get(Display* display, wl_resource* resource);
@@ -100,7 +113,6 @@ private:
     static std::shared_ptr<Buffer> make(wl_resource* wlResource, Surface* surface);
     static std::shared_ptr<Buffer> make(wl_resource* wlResource, Display* display);
 
-    Buffer(wl_resource* wlResource, Surface* surface);
     Buffer(wl_resource* wlResource, Display* display);
 
     class Private;
@@ -0,0 +1,187 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include "buffer_mapping.h"
+
+#include "damage_list.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace Wrapland::Server
+{
+
+namespace
+{
+
+constexpr size_t batch_size{16};
+
+// Undoing a buffer transform swaps the axes or not and then mirrors them in the surface.
+struct transform_steps {
+    bool swap;
+    bool mirror_x;
+    bool mirror_y;
+};
+
+transform_steps inverse_steps(output_transform transform)
+{
+    using ot = output_transform;
+
+    switch (transform) {
+    case ot::normal:
+        return {false, false, false};
+    case ot::rotated_90:
+        return {true, false, true};
+    case ot::rotated_180:
+        return {false, true, true};
+    case ot::rotated_270:
+        return {true, true, false};
+    case ot::flipped:
+        return {false, true, false};
+    case ot::flipped_90:
+        return {true, true, true};
+    case ot::flipped_180:
+        return {false, false, true};
+    case ot::flipped_270:
+        return {true, false, false};
+    }
+
+    return {false, false, false};
+}
+
+}
+
+QSize buffer_mapping::surface_size() const
+{
+    if (destination.isValid()) {
+        return destination;
+    }
+    if (source.isValid()) {
+        return source.size().toSize();
+    }
+
+    auto size = buffer_size / std::max(scale, 1);
+    if (inverse_steps(transform).swap) {
+        size.transpose();
+    }
+    return size;
+}
+
+size_t buffer_mapping::map(QRect const* rects, size_t count, QRect* mapped) const
+{
+    if (buffer_size.isEmpty()) {
+        return 0;
+    }
+
+    auto const steps = inverse_steps(transform);
+    auto const size = steps.swap ? buffer_size.transposed() : buffer_size;
+    auto const buffer_scale = static_cast<double>(std::max(scale, 1));
+
+    // Everything is computed in transformed buffer pixels and divided once at the end. With
+    // dyadic viewport values the numerators are exact, so integral results are never rounded.
+    auto const src = source.isValid()
+        ? source
+        : QRectF(0, 0, size.width() / buffer_scale, size.height() / buffer_scale);
+    auto const dst = destination.isValid() ? QSizeF(destination) : src.size();
+
+    auto const src_x1 = src.left() * buffer_scale;
+    auto const src_y1 = src.top() * buffer_scale;
+    auto const src_x2 = src.right() * buffer_scale;
+    auto const src_y2 = src.bottom() * buffer_scale;
+    auto const src_width = src.width() * buffer_scale;
+    auto const src_height = src.height() * buffer_scale;
+
+    auto const extent_x = static_cast<double>(size.width());
+    auto const extent_y = static_cast<double>(size.height());
+
+    size_t written{0};
+
+    for (size_t begin = 0; begin < count; begin += batch_size) {
+        auto const batch_count = std::min(batch_size, count - begin);
+
+        std::array<double, batch_size> x1;
+        std::array<double, batch_size> y1;
+        std::array<double, batch_size> x2;
+        std::array<double, batch_size> y2;
+
+        // No branches depend on the rectangles here, so the compiler can vectorize the batch.
+        for (size_t index = 0; index < batch_count; index++) {
+            auto const& rect = rects[begin + index];
+
+            auto const left = static_cast<double>(rect.x());
+            auto const top = static_cast<double>(rect.y());
+            auto const right = left + rect.width();
+            auto const bottom = top + rect.height();
+
+            auto const u1 = steps.swap ? top : left;
+            auto const u2 = steps.swap ? bottom : right;
+            auto const v1 = steps.swap ? left : top;
+            auto const v2 = steps.swap ? right : bottom;
+
+            auto const tx1 = steps.mirror_x ? extent_x - u2 : u1;
+            auto const tx2 = steps.mirror_x ? extent_x - u1 : u2;
+            auto const ty1 = steps.mirror_y ? extent_y - v2 : v1;
+            auto const ty2 = steps.mirror_y ? extent_y - v1 : v2;
+
+            x1[index] = (std::clamp(tx1, src_x1, src_x2) - src_x1) * dst.width() / src_width;
+            x2[index] = (std::clamp(tx2, src_x1, src_x2) - src_x1) * dst.width() / src_width;
+            y1[index] = (std::clamp(ty1, src_y1, src_y2) - src_y1) * dst.height() / src_height;
+            y2[index] = (std::clamp(ty2, src_y1, src_y2) - src_y1) * dst.height() / src_height;
+        }
+
+        for (size_t index = 0; index < batch_count; index++) {
+            auto const left = static_cast<int>(std::floor(x1.at(index)));
+            auto const top = static_cast<int>(std::floor(y1.at(index)));
+            auto const right = static_cast<int>(std::ceil(x2.at(index)));
+            auto const bottom = static_cast<int>(std::ceil(y2.at(index)));
+
+            if (left < right && top < bottom) {
+                mapped[written] = QRect(left, top, right - left, bottom - top);
+                written++;
+            }
+        }
+    }
+
+    return written;
+}
+
+rect_region buffer_mapping::map(damage_list const& damage) const
+{
+    if (damage.size() == 1) {
+        QRect single;
+        damage.for_each([&single](auto const& rect) { single = rect; });
+        QRect mapped;
+        return map(&single, 1, &mapped) == 1 ? rect_region(mapped) : rect_region();
+    }
+
+    // United in one pass at the end, rect by rect is quadratic when the damage limit is disabled.
+    std::vector<QRect> rects;
+    rects.reserve(damage.size());
+
+    std::array<QRect, batch_size> batch;
+    std::array<QRect, batch_size> mapped;
+    size_t count{0};
+
+    auto map_batch = [&] {
+        auto const written = map(batch.data(), count, mapped.data());
+        rects.insert(rects.end(), mapped.begin(), mapped.begin() + written);
+        count = 0;
+    };
+
+    damage.for_each([&](auto const& rect) {
+        batch.at(count) = rect;
+        count++;
+        if (count == batch_size) {
+            map_batch();
+        }
+    });
+    map_batch();
+
+    return rect_region::from_rects(rects);
+}
+
+}
@@ -0,0 +1,49 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include "output.h"
+#include "rect_region.h"
+
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Wrapland::Server
+{
+
+class damage_list;
+
+/**
+ * Mapping of buffer pixels to surface-local coordinates. The buffer transform is undone first,
+ * then the buffer scale is divided out and at last the viewport crops to its source rectangle and
+ * scales that to its destination size.
+ *
+ * Mapped rectangles are rounded outwards, so surface pixels showing any part of a damaged buffer
+ * pixel are always included.
+ */
+struct buffer_mapping {
+    QSize buffer_size;
+    int32_t scale{1};
+    output_transform transform{output_transform::normal};
+
+    // Viewport source in surface coordinates before the viewport scales. Invalid when not set.
+    QRectF source;
+    // Viewport destination. Invalid when not set.
+    QSize destination;
+
+    QSize surface_size() const;
+
+    /// Maps @arg count rectangles from @arg rects to @arg mapped. Rectangles outside the viewport
+    /// source are dropped. Returns the number of rectangles written.
+    size_t map(QRect const* rects, size_t count, QRect* mapped) const;
+    rect_region map(damage_list const& damage) const;
+};
+
+}
@@ -20,6 +20,12 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "buffer.h"
 
+#include "wayland/object_pool.h"
+
+#include <QPointer>
+
+#include <memory>
+
 #include <wayland-server.h>
 
 namespace Wrapland::Server
@@ -56,20 +62,30 @@ private:
     QImage image;
 };
 
-class Buffer::Private
+class Buffer::Private : public Wayland::pooled<Buffer::Private>
 {
 public:
-    Private(Buffer* q_ptr, wl_resource* wlResource, Surface* surface, Wayland::Display* display);
+    Private(Buffer* q_ptr, wl_resource* wlResource, Wayland::Display* display);
     ~Private();
 
+    std::shared_ptr<Buffer> attach(std::shared_ptr<Buffer> const& owner);
+    void release();
+
+    void probe_egl();
+
     wl_resource* resource;
     wl_shm_buffer* shmBuffer;
     linux_dmabuf_buffer_v1* dmabufBuffer{nullptr};
 
-    Surface* surface;
-    int refCount{0};
     QSize size;
     bool alpha{false};
+    bool egl_probed{false};
+    bool immediate_release{false};
+
+    // Per attachment state. Reset when the attachment is released.
+    std::weak_ptr<Buffer> attachment;
+    // The surface that attached the buffer last. The buffer may outlive it.
+    QPointer<Surface> surface;
     bool committed{false};
 
     Wayland::Display* display;
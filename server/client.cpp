@@ -21,6 +21,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "client_p.h"
 
 #include "wayland/client.h"
+#include "wayland/display.h"
 
 #include "display.h"
 
@@ -88,4 +89,19 @@ void Client::set_security_context_app_id(std::string const& id)
     d_ptr->set_security_context_app_id(id);
 }
 
+std::vector<protocol_stats_entry> Client::protocol_stats() const
+{
+    if (!d_ptr->native) {
+        return {};
+    }
+    return d_ptr->display()->protocol_stats(d_ptr->native);
+}
+
+void Client::reset_protocol_stats()
+{
+    if (d_ptr->native) {
+        d_ptr->display()->reset_protocol_stats(d_ptr->native);
+    }
+}
+
 }
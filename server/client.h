@@ -23,9 +23,12 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <Wrapland/Server/wraplandserver_export.h>
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <sys/types.h>
+#include <vector>
 
 struct wl_client;
 struct wl_interface;
@@ -42,6 +45,21 @@ class Client;
 class Display;
 }
 
+/// Protocol traffic of a client for one request or event.
+struct protocol_stats_entry {
+    std::string interface;
+    std::string message;
+    uint32_t opcode{0};
+    /// Request received from the client, otherwise event sent to it.
+    bool is_request{false};
+
+    uint64_t count{0};
+    /// Bytes on the wire. File descriptors passed along are not included.
+    uint64_t bytes{0};
+    /// Time spent in the request handlers. Zero for events.
+    std::chrono::nanoseconds dispatch_time{0};
+};
+
 class WRAPLANDSERVER_EXPORT Client : public QObject
 {
     Q_OBJECT
@@ -62,6 +80,13 @@ public:
     std::string security_context_app_id() const;
     void set_security_context_app_id(std::string const& id);
 
+    /**
+     * Traffic per request and event since the last reset. Only collected while protocol statistics
+     * are enabled on the display.
+     */
+    std::vector<protocol_stats_entry> protocol_stats() const;
+    void reset_protocol_stats();
+
 Q_SIGNALS:
     void disconnected(Client*);
 
@@ -27,6 +27,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "wayland/global.h"
 
 #include <algorithm>
+#include <cassert>
 #include <vector>
 
 namespace Wrapland::Server
@@ -40,6 +41,10 @@ class Compositor::Private : public CompositorGlobal
 public:
     Private(Compositor* q_ptr, Display* display);
 
+    void remove_surface(Surface* surface);
+
+    // Unordered. Surfaces are swapped with the last one on removal so that destroying all surfaces
+    // of a client does not scan the list once per surface.
     std::vector<Surface*> surfaces;
 
 private:
@@ -75,15 +80,26 @@ void Compositor::Private::createSurfaceCallback(CompositorGlobal::bind_t* bind,
     auto surface = new Surface(bind->client->handle, bind->version, id);
     // TODO(romangg): error handling (when resource not created)
 
+    surface->d_ptr->compositor_index = priv->surfaces.size();
     priv->surfaces.push_back(surface);
     connect(surface, &Surface::resourceDestroyed, priv->handle, [priv, surface] {
-        priv->surfaces.erase(std::remove(priv->surfaces.begin(), priv->surfaces.end(), surface),
-                             priv->surfaces.end());
+        priv->remove_surface(surface);
     });
 
     Q_EMIT priv->handle->surfaceCreated(surface);
 }
 
+void Compositor::Private::remove_surface(Surface* surface)
+{
+    auto const index = surface->d_ptr->compositor_index;
+    assert(index < surfaces.size() && surfaces.at(index) == surface);
+
+    auto last = surfaces.back();
+    surfaces.at(index) = last;
+    last->d_ptr->compositor_index = index;
+    surfaces.pop_back();
+}
+
 void Compositor::Private::createRegionCallback(CompositorGlobal::bind_t* bind, uint32_t id)
 {
     auto compositor = bind->global()->handle;
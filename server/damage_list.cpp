@@ -0,0 +1,77 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include "damage_list.h"
+
+namespace Wrapland::Server
+{
+
+void damage_list::add(QRect const& rect, size_t limit)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    m_bounds = m_bounds.united(rect);
+
+    if (m_collapsed) {
+        m_inline.front() = m_bounds;
+        return;
+    }
+
+    if (limit > 0 && m_count >= limit) {
+        m_inline.front() = m_bounds;
+        m_spill.clear();
+        m_count = 1;
+        m_collapsed = true;
+        return;
+    }
+
+    if (m_count < inline_count) {
+        m_inline.at(m_count) = rect;
+    } else {
+        m_spill.push_back(rect);
+    }
+    m_count++;
+}
+
+void damage_list::clear()
+{
+    // The spill vector keeps its capacity for the next frame.
+    m_spill.clear();
+    m_count = 0;
+    m_bounds = {};
+    m_collapsed = false;
+}
+
+bool damage_list::empty() const
+{
+    return m_count == 0;
+}
+
+size_t damage_list::size() const
+{
+    return m_count;
+}
+
+bool damage_list::collapsed() const
+{
+    return m_collapsed;
+}
+
+rect_region damage_list::region() const
+{
+    if (m_count <= 1) {
+        return m_count == 0 ? rect_region() : rect_region(m_inline.front());
+    }
+
+    // Uniting rect by rect is quadratic when the limit is disabled.
+    std::vector<QRect> rects;
+    rects.reserve(m_count);
+    for_each([&rects](auto const& rect) { rects.push_back(rect); });
+    return rect_region::from_rects(rects);
+}
+
+}
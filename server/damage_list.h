@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include "rect_region.h"
+
+#include <QRect>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace Wrapland::Server
+{
+
+/**
+ * Damage rectangles requested by a client for its next commit. Requests only append to the list,
+ * it is turned into a region once on commit. When the list is full all damage collapses into its
+ * bounding rectangle, so the cost of a commit stays bounded however many rectangles are sent.
+ */
+class damage_list
+{
+public:
+    /// Adds @arg rect. With @arg limit rectangles already listed all damage collapses instead.
+    /// Zero disables the limit.
+    void add(QRect const& rect, size_t limit);
+    void clear();
+
+    bool empty() const;
+    size_t size() const;
+    bool collapsed() const;
+
+    rect_region region() const;
+
+    template<typename F>
+    void for_each(F const& func) const
+    {
+        auto const inline_size = std::min(m_count, inline_count);
+        for (size_t i = 0; i < inline_size; i++) {
+            func(m_inline.at(i));
+        }
+        for (auto const& rect : m_spill) {
+            func(rect);
+        }
+    }
+
+private:
+    // Covers the default limit of the display without going to the heap.
+    static constexpr size_t inline_count{16};
+
+    std::array<QRect, inline_count> m_inline;
+    std::vector<QRect> m_spill;
+    size_t m_count{0};
+
+    QRect m_bounds;
+    bool m_collapsed{false};
+};
+
+}
@@ -22,8 +22,10 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "client.h"
 #include "client_p.h"
 
+#include "wayland/buffer_manager.h"
 #include "wayland/client.h"
 #include "wayland/display.h"
+#include "wayland/object_pool.h"
 
 #include "appmenu.h"
 #include "blur.h"
@@ -57,6 +59,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "shadow.h"
 #include "slide.h"
 #include "subcompositor.h"
+#include "surface_p.h"
 #include "text_input_v2.h"
 #include "text_input_v3.h"
 #include "viewporter.h"
@@ -73,6 +76,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <EGL/egl.h>
 
 #include <algorithm>
+#include <unistd.h>
 #include <wayland-server.h>
 
 namespace Wrapland::Server
@@ -101,6 +105,12 @@ void Display::start()
     Q_EMIT started();
 }
 
+void Display::start_external_loop()
+{
+    d_ptr->start_external_loop();
+    Q_EMIT started();
+}
+
 void Display::startLoop()
 {
     d_ptr->startLoop();
@@ -116,11 +126,50 @@ void Display::dispatch()
     d_ptr->dispatch();
 }
 
+bool Display::dispatch(dispatch_budget const& budget)
+{
+    return d_ptr->dispatch(budget);
+}
+
+int Display::event_loop_fd() const
+{
+    return d_ptr->event_loop_fd();
+}
+
 void Display::flush()
 {
     d_ptr->flush();
 }
 
+void Display::frames_rendered(std::vector<Surface*> const& surfaces, uint32_t msec)
+{
+    std::vector<Surface*> stack(surfaces.rbegin(), surfaces.rend());
+    std::vector<wl_client*> clients;
+
+    while (!stack.empty()) {
+        auto surface = stack.back();
+        stack.pop_back();
+
+        if (surface->d_ptr->frame_rendered(msec)) {
+            clients.push_back(surface->d_ptr->client->native);
+        }
+
+        auto const& children = surface->state().children;
+        for (auto it = children.rbegin(); it != children.rend(); it++) {
+            if (auto child = (*it)->surface()) {
+                stack.push_back(child);
+            }
+        }
+    }
+
+    std::sort(clients.begin(), clients.end());
+    clients.erase(std::unique(clients.begin(), clients.end()), clients.end());
+
+    for (auto client : clients) {
+        d_ptr->flush(client);
+    }
+}
+
 void Display::terminate()
 {
     d_ptr->terminate();
@@ -204,4 +253,70 @@ void* Display::eglDisplay() const
     return d_ptr->eglDisplay;
 }
 
+buffer_release_stats Display::get_buffer_release_stats() const
+{
+    return d_ptr->bufferManager()->release_stats();
+}
+
+client_flush_stats Display::get_client_flush_stats() const
+{
+    return d_ptr->flush_stats();
+}
+
+object_pool_stats Display::get_object_pool_stats() const
+{
+    auto const& counters = Wayland::pool_counters();
+    return {counters.allocations, counters.reused};
+}
+
+void Display::set_client_buffer_limit(size_t bytes)
+{
+    d_ptr->set_client_buffer_limit(bytes);
+}
+
+size_t Display::client_buffer_limit() const
+{
+    return d_ptr->client_buffer_limit();
+}
+
+void Display::set_damage_rect_limit(size_t count)
+{
+    d_ptr->set_damage_rect_limit(count);
+}
+
+size_t Display::damage_rect_limit() const
+{
+    return d_ptr->damage_rect_limit();
+}
+
+void Display::set_protocol_stats_enabled(bool enable)
+{
+    d_ptr->set_protocol_stats_enabled(enable);
+}
+
+bool Display::protocol_stats_enabled() const
+{
+    return d_ptr->protocol_stats_enabled();
+}
+
+void Display::reset_protocol_stats()
+{
+    d_ptr->reset_protocol_stats();
+}
+
+void Display::set_trace_capacity(size_t records)
+{
+    d_ptr->trace().set_capacity(records);
+}
+
+size_t Display::trace_capacity() const
+{
+    return d_ptr->trace().capacity();
+}
+
+std::string Display::dump_trace() const
+{
+    return d_ptr->trace().to_json(getpid());
+}
+
 }
@@ -22,6 +22,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <Wrapland/Server/wraplandserver_export.h>
 
 #include <QObject>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -69,6 +70,7 @@ class ServerSideDecorationPaletteManager;
 class ShadowManager;
 class SlideManager;
 class Subcompositor;
+class Surface;
 class text_input_manager_v2;
 class text_input_manager_v3;
 class Viewporter;
@@ -84,6 +86,47 @@ namespace Wayland
 {
 class Display;
 }
+
+struct buffer_release_stats {
+    /// Buffer releases sent to clients.
+    uint64_t sent{0};
+    /// Releases that were flushed to their client right away.
+    uint64_t immediate{0};
+    /// Client flushes avoided by sending queued releases together on display flush.
+    uint64_t flushes_saved{0};
+};
+
+struct client_flush_stats {
+    /// Flushes of the display.
+    uint64_t flushes{0};
+    /// Clients flushed because events were queued for them.
+    uint64_t clients_flushed{0};
+    /// Clients not visited on a flush because nothing was queued for them.
+    uint64_t clients_skipped{0};
+    /// Fallbacks to flushing all clients because a client socket was full or broken.
+    uint64_t full_flushes{0};
+    /// Times a client was found not to read its events and switched to coalescing them.
+    uint64_t congestions{0};
+    /// Events held back for such clients until they read again.
+    uint64_t events_deferred{0};
+    /// Held back events dropped because a newer state replaced them.
+    uint64_t events_replaced{0};
+};
+
+struct object_pool_stats {
+    /// Regions, presentation feedbacks, viewports and buffers allocated.
+    uint64_t allocations{0};
+    /// Allocations that reused the memory of a destroyed object instead of the heap.
+    uint64_t reused{0};
+};
+
+struct dispatch_budget {
+    /// Time after which dispatching stops. Zero means no time limit.
+    std::chrono::nanoseconds time{0};
+    /// Number of client requests after which dispatching stops. Zero means no request limit.
+    size_t requests{0};
+};
+
 class WRAPLANDSERVER_EXPORT Display : public QObject
 {
     Q_OBJECT
@@ -112,6 +155,32 @@ public:
     void dispatch();
     void flush();
 
+    /**
+     * Sends the frame callbacks of the @arg surfaces and all their subsurfaces, like
+     * Surface::frameRendered does for each, and flushes every client that got them once right
+     * away. So clients wake up together after presentation instead of on the next flush.
+     */
+    void frames_rendered(std::vector<Surface*> const& surfaces, uint32_t msec);
+
+    /**
+     * Starts the display without integrating it into the Qt event loop. The caller owns the loop:
+     * it polls event_loop_fd() for readability, calls dispatch(budget) when it becomes readable
+     * and flush() before going to sleep again.
+     *
+     * Signals are emitted directly on the calling thread. Queued connections and timers still
+     * need a Qt event loop on that thread to be processed.
+     */
+    void start_external_loop();
+    int event_loop_fd() const;
+
+    /**
+     * Dispatches client requests until none are pending or the @arg budget is used up. The budget
+     * is checked between dispatch rounds and may be overrun by one round.
+     *
+     * @return true if events are still pending because the budget ran out.
+     */
+    bool dispatch(dispatch_budget const& budget);
+
     Client* getClient(wl_client* client) const;
     std::vector<Client*> clients() const;
 
@@ -121,6 +190,51 @@ public:
     void setEglDisplay(void* display);
     void* eglDisplay() const;
 
+    buffer_release_stats get_buffer_release_stats() const;
+    client_flush_stats get_client_flush_stats() const;
+    /// Objects are pooled per thread. Counts all displays on the calling thread.
+    object_pool_stats get_object_pool_stats() const;
+
+    /**
+     * Maximal size in bytes of the outgoing buffer of a client. A client exceeding it is
+     * disconnected by libwayland. Clients that come close to it and do not read their socket get
+     * pointer motion, frame callbacks and window updates coalesced to the latest state until they
+     * read again. Zero keeps the libwayland default.
+     *
+     * The limit is only enforced with libwayland 1.23 or later.
+     */
+    void set_client_buffer_limit(size_t bytes);
+    size_t client_buffer_limit() const;
+
+    /**
+     * Number of damage rectangles a surface collects per commit. With more the damage of the
+     * commit is their bounding rectangle instead. Zero disables the limit. Defaults to 16.
+     */
+    void set_damage_rect_limit(size_t count);
+    size_t damage_rect_limit() const;
+
+    /**
+     * Collect per client traffic for every request and event, see Client::protocol_stats. Disabled
+     * by default, what costs a single flag check per message.
+     */
+    void set_protocol_stats_enabled(bool enable);
+    bool protocol_stats_enabled() const;
+    void reset_protocol_stats();
+
+    /**
+     * The display always records its most recent protocol activity into a fixed-size ring: client
+     * requests, events sent, surface commits and flushes. The capacity is in records and 0 turns
+     * recording off.
+     */
+    void set_trace_capacity(size_t records);
+    size_t trace_capacity() const;
+
+    /**
+     * Recorded activity as Chrome trace event JSON. The file can be opened in Perfetto or
+     * chrome://tracing. Clients appear as processes by their pid.
+     */
+    std::string dump_trace() const;
+
     struct {
         /// Basic graphical operations
         Server::Compositor* compositor{nullptr};
@@ -20,9 +20,12 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "filtered_display.h"
 
+#include "client.h"
+
 #include <wayland-server.h>
 
 #include <QByteArray>
+#include <unordered_map>
 
 namespace Wrapland::Server
 {
@@ -34,6 +37,12 @@ public:
 
     static bool filterCallback(wl_client const* wlClient, wl_global const* wlGlobal, void* data);
 
+    bool allow_interface(Client* client, wl_interface const* interface);
+
+    bool cache_decisions{false};
+    // Interfaces are identified by their static description. Several globals share one.
+    std::unordered_map<Client*, std::unordered_map<wl_interface const*, bool>> decisions;
+
 private:
     FilteredDisplay* q_ptr;
 };
@@ -59,10 +68,37 @@ bool FilteredDisplay::Private::filterCallback(wl_client const* wlClient,
         client = priv->q_ptr->createClient(const_cast<wl_client*>(wlClient));
     }
 
-    auto interface = wl_global_get_interface(wlGlobal);
-    auto name = QByteArray::fromRawData(interface->name, static_cast<int>(strlen(interface->name)));
+    return priv->allow_interface(client, wl_global_get_interface(wlGlobal));
+}
+
+bool FilteredDisplay::Private::allow_interface(Client* client, wl_interface const* interface)
+{
+    auto ask_policy = [this, client, interface] {
+        auto name
+            = QByteArray::fromRawData(interface->name, static_cast<int>(strlen(interface->name)));
+        return q_ptr->allowInterface(client, name);
+    };
+
+    if (!cache_decisions) {
+        return ask_policy();
+    }
 
-    return priv->q_ptr->allowInterface(client, name);
+    auto client_it = decisions.find(client);
+    if (client_it == decisions.end()) {
+        client_it = decisions.insert({client, {}}).first;
+        QObject::connect(client, &Client::disconnected, q_ptr, [this, client] {
+            decisions.erase(client);
+        });
+    }
+
+    auto& client_decisions = client_it->second;
+    if (auto it = client_decisions.find(interface); it != client_decisions.end()) {
+        return it->second;
+    }
+
+    auto const allowed = ask_policy();
+    client_decisions[interface] = allowed;
+    return allowed;
 }
 
 FilteredDisplay::FilteredDisplay()
@@ -78,4 +114,31 @@ FilteredDisplay::~FilteredDisplay()
     wl_display_set_global_filter(native(), nullptr, nullptr);
 }
 
+void FilteredDisplay::set_cache_decisions(bool enable)
+{
+    d_ptr->cache_decisions = enable;
+    if (!enable) {
+        invalidate_decisions();
+    }
+}
+
+bool FilteredDisplay::cache_decisions() const
+{
+    return d_ptr->cache_decisions;
+}
+
+void FilteredDisplay::invalidate_decisions(Client* client)
+{
+    if (auto it = d_ptr->decisions.find(client); it != d_ptr->decisions.end()) {
+        it->second.clear();
+    }
+}
+
+void FilteredDisplay::invalidate_decisions()
+{
+    for (auto& [client, client_decisions] : d_ptr->decisions) {
+        client_decisions.clear();
+    }
+}
+
 }
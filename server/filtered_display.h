@@ -51,6 +51,24 @@ public:
      */
     virtual bool allowInterface(Client* client, QByteArray const& interfaceName) = 0;
 
+    /**
+     * Remember the result of @method allowInterface per client and interface. Disabled by default.
+     *
+     * With caching enabled the policy is only consulted the first time a client sees a global of
+     * some interface. When the policy changes the affected decisions must be invalidated.
+     */
+    void set_cache_decisions(bool enable);
+    bool cache_decisions() const;
+
+    /**
+     * Forget the cached decisions for @arg client. Its next registry request asks the policy again.
+     */
+    void invalidate_decisions(Client* client);
+    /**
+     * Forget the cached decisions for all clients.
+     */
+    void invalidate_decisions();
+
 private:
     class Private;
     std::unique_ptr<Private> d_ptr;
@@ -68,7 +68,13 @@ idle_notification_v1::Private::Private(Client* client,
                                               q_ptr)
     , duration{duration}
     , seat{seat}
+    , watch{duration,
+            [this] { send<ext_idle_notification_v1_send_idled>(); },
+            [this] { send<ext_idle_notification_v1_send_resumed>(); }}
 {
+    if (seat) {
+        seat->d_ptr->idle.add(watch);
+    }
 }
 
 idle_notification_v1::Private::~Private() = default;
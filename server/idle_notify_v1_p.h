@@ -7,6 +7,8 @@
 
 #include "idle_notify_v1.h"
 
+#include "idle_tracker.h"
+
 #include "wayland/global.h"
 #include "wayland/resource.h"
 
@@ -46,6 +48,9 @@ public:
     std::chrono::milliseconds duration;
     Seat* seat;
 
+    // Only driven when the seat tracks idle by itself.
+    idle_watch watch;
+
 private:
     static const struct ext_idle_notification_v1_interface s_interface;
 };
@@ -0,0 +1,179 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include "idle_tracker.h"
+
+#include "display.h"
+#include "seat_p.h"
+#include "utils.h"
+
+#include "wayland/display.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Wrapland::Server
+{
+
+idle_watch::idle_watch(std::chrono::milliseconds duration,
+                       std::function<void()> idle,
+                       std::function<void()> resume)
+    : duration{duration}
+    , idle{std::move(idle)}
+    , resume{std::move(resume)}
+{
+}
+
+idle_watch::~idle_watch()
+{
+    if (tracker) {
+        tracker->remove(*this);
+    }
+}
+
+idle_tracker::idle_tracker(Wayland::TimerWheel& wheel)
+    : m_wheel{wheel}
+    , m_last_activity{std::chrono::steady_clock::now()}
+{
+}
+
+idle_tracker::~idle_tracker()
+{
+    for (auto watch : m_watches) {
+        watch->timer.reset();
+        watch->tracker = nullptr;
+    }
+}
+
+void idle_tracker::add(idle_watch& watch)
+{
+    assert(!watch.tracker);
+
+    watch.tracker = this;
+    watch.timer.emplace(m_wheel);
+    m_watches.push_back(&watch);
+
+    if (m_enabled && !m_inhibited) {
+        arm(watch);
+    }
+}
+
+void idle_tracker::remove(idle_watch& watch)
+{
+    assert(watch.tracker == this);
+
+    watch.timer.reset();
+    watch.tracker = nullptr;
+    remove_one(m_watches, &watch);
+    remove_one(m_idle, &watch);
+}
+
+void idle_tracker::set_enabled(bool enable)
+{
+    if (m_enabled == enable) {
+        return;
+    }
+
+    m_enabled = enable;
+    m_last_activity = std::chrono::steady_clock::now();
+
+    for (auto watch : m_watches) {
+        watch->timer->cancel();
+        watch->idled = false;
+        if (enable && !m_inhibited) {
+            arm(*watch);
+        }
+    }
+    m_idle.clear();
+}
+
+bool idle_tracker::enabled() const
+{
+    return m_enabled;
+}
+
+void idle_tracker::activity()
+{
+    m_last_activity = std::chrono::steady_clock::now();
+
+    if (!m_enabled || m_idle.empty()) {
+        return;
+    }
+
+    for (auto watch : m_idle) {
+        watch->idled = false;
+        if (!m_inhibited) {
+            arm(*watch);
+        }
+        watch->resume();
+    }
+    m_idle.clear();
+}
+
+void idle_tracker::set_inhibited(bool inhibited)
+{
+    if (m_inhibited == inhibited) {
+        return;
+    }
+
+    m_inhibited = inhibited;
+
+    if (!m_enabled || inhibited) {
+        // Timeouts that expire while inhibited are not restarted.
+        return;
+    }
+
+    // The inhibition ending counts as activity for timeouts that are not idle already.
+    m_last_activity = std::chrono::steady_clock::now();
+    for (auto watch : m_watches) {
+        if (!watch->idled && !watch->timer->active()) {
+            arm(*watch);
+        }
+    }
+}
+
+void idle_tracker::arm(idle_watch& watch)
+{
+    auto const deadline = m_last_activity + watch.duration;
+    auto const remaining = std::chrono::ceil<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+
+    watch.timer->start(std::max(remaining, std::chrono::milliseconds::zero()),
+                       [this, &watch] { check(watch); });
+}
+
+void idle_tracker::check(idle_watch& watch)
+{
+    if (!m_enabled || m_inhibited) {
+        return;
+    }
+
+    if (std::chrono::steady_clock::now() - m_last_activity < watch.duration) {
+        // Activity since the timeout was started.
+        arm(watch);
+        return;
+    }
+
+    watch.idled = true;
+    m_idle.push_back(&watch);
+    watch.idle();
+}
+
+void idle_tracker::update_inhibition(Wayland::Display& display, bool inhibiting)
+{
+    auto& count = display.idle_inhibiting_surfaces;
+    assert(inhibiting || count > 0);
+
+    count = inhibiting ? count + 1 : count - 1;
+    if (count > 1 || (count == 1 && !inhibiting)) {
+        return;
+    }
+
+    for (auto seat : display.handle->globals.seats) {
+        seat->d_ptr->idle.set_inhibited(count > 0);
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include "wayland/timer_wheel.h"
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace Wrapland::Server
+{
+
+namespace Wayland
+{
+class Display;
+}
+
+class idle_tracker;
+
+/// Timeout of a single idle notification object.
+struct idle_watch {
+    idle_watch(std::chrono::milliseconds duration,
+               std::function<void()> idle,
+               std::function<void()> resume);
+    ~idle_watch();
+
+    idle_watch(idle_watch const&) = delete;
+    idle_watch& operator=(idle_watch const&) = delete;
+    idle_watch(idle_watch&&) noexcept = delete;
+    idle_watch& operator=(idle_watch&&) noexcept = delete;
+
+    std::chrono::milliseconds duration;
+    std::function<void()> idle;
+    std::function<void()> resume;
+
+    idle_tracker* tracker{nullptr};
+    std::optional<Wayland::Timer> timer;
+    bool idled{false};
+};
+
+/**
+ * Idle state of a seat. User activity only updates a timestamp. The timeouts check it when they
+ * expire and go idle or restart for the remaining time, so activity costs nothing per
+ * notification unless a notification has to be resumed.
+ */
+class idle_tracker
+{
+public:
+    explicit idle_tracker(Wayland::TimerWheel& wheel);
+    ~idle_tracker();
+
+    idle_tracker(idle_tracker const&) = delete;
+    idle_tracker& operator=(idle_tracker const&) = delete;
+    idle_tracker(idle_tracker&&) noexcept = delete;
+    idle_tracker& operator=(idle_tracker&&) noexcept = delete;
+
+    void add(idle_watch& watch);
+    void remove(idle_watch& watch);
+
+    void set_enabled(bool enable);
+    bool enabled() const;
+
+    void activity();
+    void set_inhibited(bool inhibited);
+
+    /// Counts surfaces inhibiting idle over all seats of the display.
+    static void update_inhibition(Wayland::Display& display, bool inhibiting);
+
+private:
+    void arm(idle_watch& watch);
+    void check(idle_watch& watch);
+
+    Wayland::TimerWheel& m_wheel;
+
+    std::vector<idle_watch*> m_watches;
+    std::vector<idle_watch*> m_idle;
+
+    std::chrono::steady_clock::time_point m_last_activity;
+    bool m_enabled{false};
+    bool m_inhibited{false};
+};
+
+}
@@ -68,7 +68,13 @@ kde_idle_timeout::Private::Private(Client* client,
                                           q_ptr)
     , duration{duration}
     , seat{seat}
+    , watch{duration,
+            [this] { send<org_kde_kwin_idle_timeout_send_idle>(); },
+            [this] { send<org_kde_kwin_idle_timeout_send_resumed>(); }}
 {
+    if (seat) {
+        seat->d_ptr->idle.add(watch);
+    }
 }
 
 kde_idle_timeout::Private::~Private() = default;
@@ -76,7 +82,11 @@ kde_idle_timeout::Private::~Private() = default;
 void kde_idle_timeout::Private::simulate_user_activity_callback(wl_client* /*wlClient*/,
                                                                 wl_resource* wlResource)
 {
-    Q_EMIT get_handle(wlResource)->simulate_user_activity();
+    auto handle = get_handle(wlResource);
+    if (auto seat = handle->d_ptr->seat) {
+        seat->d_ptr->idle.activity();
+    }
+    Q_EMIT handle->simulate_user_activity();
 }
 
 kde_idle_timeout::kde_idle_timeout(Client* client,
@@ -8,6 +8,8 @@
 
 #include "kde_idle.h"
 
+#include "idle_tracker.h"
+
 #include "wayland/global.h"
 #include "wayland/resource.h"
 
@@ -47,6 +49,9 @@ public:
     std::chrono::milliseconds duration;
     Seat* seat;
 
+    // Only driven when the seat tracks idle by itself.
+    idle_watch watch;
+
 private:
     static void simulate_user_activity_callback(wl_client* wlClient, wl_resource* wlResource);
     static const struct org_kde_kwin_idle_timeout_interface s_interface;
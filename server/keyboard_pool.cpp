@@ -5,13 +5,17 @@
     SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
 */
 #include "keyboard_pool.h"
+#include "client.h"
 #include "display.h"
 #include "keyboard.h"
 #include "keyboard_p.h"
 #include "seat.h"
 #include "seat_p.h"
+#include "surface.h"
 #include "utils.h"
 
+#include "wayland/probes.h"
+
 #include <algorithm>
 
 namespace Wrapland::Server
@@ -88,6 +92,11 @@ void keyboard_pool::key(uint32_t key, key_state state)
         return;
     }
     if (focus.surface) {
+        WRAPLAND_PROBE(keyboard_key,
+                       Wayland::probe_pid(focus.surface),
+                       Wayland::probe_id(focus.surface),
+                       key,
+                       static_cast<int32_t>(state));
         for (auto kbd : focus.devices) {
             kbd->key(lastStateSerial, key, state);
         }
@@ -111,6 +120,13 @@ void keyboard_pool::update_modifiers(uint32_t depressed,
     modifiers.serial = serial;
 
     if (focus.surface) {
+        WRAPLAND_PROBE(keyboard_modifiers,
+                       Wayland::probe_pid(focus.surface),
+                       Wayland::probe_id(focus.surface),
+                       depressed,
+                       latched,
+                       locked,
+                       group);
         for (auto& keyboard : focus.devices) {
             keyboard->updateModifiers(serial, depressed, latched, locked, group);
         }
@@ -143,7 +143,7 @@ void output::Private::done_wl(Client* client) const
         return;
     }
 
-    auto binds = wayland_output->d_ptr->getBinds(client);
+    auto const& binds = wayland_output->d_ptr->getBinds(client);
     for (auto bind : binds) {
         wayland_output->d_ptr->done(bind);
     }
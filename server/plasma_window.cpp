@@ -439,7 +439,7 @@ void PlasmaWindow::Private::setTitle(QString const& title)
     m_title = title;
     QByteArray const utf8 = m_title.toUtf8();
     for (auto&& res : resources) {
-        res->d_ptr->send<org_kde_plasma_window_send_title_changed>(utf8.constData());
+        res->d_ptr->send_title(utf8);
     }
 }
 
@@ -515,8 +515,7 @@ void PlasmaWindow::Private::setGeometry(QRect const& geo)
         if (wl_resource_get_version(resource) < ORG_KDE_PLASMA_WINDOW_GEOMETRY_SINCE_VERSION) {
             continue;
         }
-        res->d_ptr->send<org_kde_plasma_window_send_geometry>(
-            geometry.x(), geometry.y(), geometry.width(), geometry.height());
+        res->d_ptr->send_geometry(geometry);
     }
 }
 
@@ -812,7 +811,39 @@ PlasmaWindowRes::Private::Private(Wayland::Client* client,
                                          &s_interface,
                                          q_ptr)
     , window(window)
+    , display{client->display()}
+{
+}
+
+PlasmaWindowRes::Private::~Private()
+{
+    auto wlClient = wl_resource_get_client(resource);
+    display->drop_deferred_event(wlClient, &deferred.title);
+    display->drop_deferred_event(wlClient, &deferred.geometry);
+}
+
+void PlasmaWindowRes::Private::send_title(QByteArray const& title)
+{
+    if (display->coalescing(client->native)) {
+        display->defer_event(client->native, &deferred.title, [this, title] {
+            send<org_kde_plasma_window_send_title_changed>(title.constData());
+        });
+        return;
+    }
+    send<org_kde_plasma_window_send_title_changed>(title.constData());
+}
+
+void PlasmaWindowRes::Private::send_geometry(QRect const& geometry)
 {
+    if (display->coalescing(client->native)) {
+        display->defer_event(client->native, &deferred.geometry, [this, geometry] {
+            send<org_kde_plasma_window_send_geometry>(
+                geometry.x(), geometry.y(), geometry.width(), geometry.height());
+        });
+        return;
+    }
+    send<org_kde_plasma_window_send_geometry>(
+        geometry.x(), geometry.y(), geometry.width(), geometry.height());
 }
 
 const struct org_kde_plasma_window_interface PlasmaWindowRes::Private::s_interface = {
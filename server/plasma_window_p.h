@@ -154,8 +154,20 @@ public:
             uint32_t id,
             PlasmaWindow* window,
             PlasmaWindowRes* q_ptr);
+    ~Private() override;
+
+    void send_title(QByteArray const& title);
+    void send_geometry(QRect const& geometry);
 
     PlasmaWindow* window;
+    // The client object is gone when the resource is destroyed with its client.
+    Wayland::Display* display;
+
+    // Keys for updates held back while the client does not read its events.
+    struct {
+        char title{0};
+        char geometry{0};
+    } deferred;
 
 private:
     static void setStateCallback(wl_client* client,
@@ -69,9 +69,15 @@ Pointer::Private::Private(Client* client,
                           Pointer* q_ptr)
     : Wayland::Resource<Pointer>(client, version, id, &wl_pointer_interface, &s_interface, q_ptr)
     , seat{_seat}
+    , display{client->display()}
 {
 }
 
+Pointer::Private::~Private()
+{
+    display->drop_deferred_event(wl_resource_get_client(resource), this);
+}
+
 void Pointer::Private::setCursor(quint32 serial, Surface* surface, QPoint const& hotspot)
 {
     if (!cursor) {
@@ -86,6 +92,7 @@ void Pointer::Private::setCursor(quint32 serial, Surface* surface, QPoint const&
 
 void Pointer::Private::sendEnter(quint32 serial, Surface* surface, QPointF const& pos)
 {
+    send_deferred_motion();
     send<wl_pointer_send_enter>(serial,
                                 surface->d_ptr->resource,
                                 wl_fixed_from_double(pos.x()),
@@ -97,6 +104,7 @@ void Pointer::Private::sendLeave(quint32 serial, Surface* surface)
     if (!surface) {
         return;
     }
+    send_deferred_motion();
     send<wl_pointer_send_leave>(serial, surface->d_ptr->resource);
 }
 
@@ -111,6 +119,13 @@ void Pointer::Private::sendFrame()
     send<wl_pointer_send_frame, WL_POINTER_FRAME_SINCE_VERSION>();
 }
 
+void Pointer::Private::send_deferred_motion()
+{
+    // Only the motion of this pointer. Events held back for other objects of the client stay
+    // coalesced while it is slow.
+    display->send_deferred_event(client->native, this);
+}
+
 void Pointer::Private::registerRelativePointer(RelativePointerV1* relativePointer)
 {
     relativePointers.push_back(relativePointer);
@@ -303,6 +318,7 @@ void Pointer::buttonPressed(quint32 serial, quint32 button)
 {
     Q_ASSERT(d_ptr->focusedSurface);
 
+    d_ptr->send_deferred_motion();
     d_ptr->send<wl_pointer_send_button>(
         serial, d_ptr->seat->timestamp(), button, WL_POINTER_BUTTON_STATE_PRESSED);
 }
@@ -311,6 +327,7 @@ void Pointer::buttonReleased(quint32 serial, quint32 button)
 {
     Q_ASSERT(d_ptr->focusedSurface);
 
+    d_ptr->send_deferred_motion();
     d_ptr->send<wl_pointer_send_button>(
         serial, d_ptr->seat->timestamp(), button, WL_POINTER_BUTTON_STATE_RELEASED);
 }
@@ -321,6 +338,7 @@ void Pointer::axis(Qt::Orientation orientation,
                    PointerAxisSource source)
 {
     Q_ASSERT(d_ptr->focusedSurface);
+    d_ptr->send_deferred_motion();
 
     auto const wlOrientation = (orientation == Qt::Vertical) ? WL_POINTER_AXIS_VERTICAL_SCROLL
                                                              : WL_POINTER_AXIS_HORIZONTAL_SCROLL;
@@ -369,6 +387,7 @@ void Pointer::axis(Qt::Orientation orientation,
 void Pointer::axis(Qt::Orientation orientation, quint32 delta)
 {
     Q_ASSERT(d_ptr->focusedSurface);
+    d_ptr->send_deferred_motion();
     auto const wlorient = (orientation == Qt::Vertical) ? WL_POINTER_AXIS_VERTICAL_SCROLL
                                                         : WL_POINTER_AXIS_HORIZONTAL_SCROLL;
     d_ptr->send<wl_pointer_send_axis>(
@@ -408,6 +427,16 @@ void Pointer::motion(QPointF const& position)
         return;
     }
 
+    auto display = d_ptr->client->display();
+    if (display->coalescing(d_ptr->client->native)) {
+        // Only the latest position per frame reaches a client that does not read its events.
+        display->defer_event(d_ptr->client->native, d_ptr, [priv = d_ptr, position] {
+            priv->sendMotion(position);
+            priv->sendFrame();
+        });
+        return;
+    }
+
     d_ptr->sendMotion(position);
 }
 
@@ -425,6 +454,10 @@ void Pointer::relativeMotion(QSizeF const& delta,
 
 void Pointer::frame()
 {
+    if (d_ptr->client->display()->has_deferred_event(d_ptr->client->native, d_ptr)) {
+        // Sent with the held back motion.
+        return;
+    }
     d_ptr->sendFrame();
 }
 
@@ -57,8 +57,11 @@ class Pointer::Private : public Wayland::Resource<Pointer>
 {
 public:
     Private(Client* client, uint32_t version, uint32_t id, Seat* _seat, Pointer* q_ptr);
+    ~Private() override;
 
     Seat* seat;
+    // The client object is gone when the pointer is destroyed with its client.
+    Wayland::Display* display;
 
     Surface* focusedSurface = nullptr;
     QMetaObject::Connection surfaceDestroyConnection;
@@ -75,6 +78,10 @@ public:
     void sendMotion(QPointF const& position);
     void sendFrame();
 
+    // Motion held back for a client that does not read its events. Other pointer events must not
+    // overtake it.
+    void send_deferred_motion();
+
     void registerRelativePointer(RelativePointerV1* relativePointer);
     void registerSwipeGesture(PointerSwipeGestureV1* gesture);
     void registerPinchGesture(PointerPinchGestureV1* gesture);
@@ -5,6 +5,7 @@
     SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
 */
 #include "pointer_pool.h"
+#include "client.h"
 #include "data_device.h"
 #include "display.h"
 #include "pointer_p.h"
@@ -12,6 +13,8 @@
 #include "seat_p.h"
 #include "utils.h"
 
+#include "wayland/probes.h"
+
 #include <QHash>
 #include <unordered_set>
 
@@ -129,6 +132,11 @@ void pointer_pool::set_position(QPointF const& position)
 {
     if (pos != position) {
         pos = position;
+        WRAPLAND_PROBE(pointer_motion,
+                       Wayland::probe_pid(focus.surface),
+                       Wayland::probe_id(focus.surface),
+                       static_cast<int32_t>(position.x()),
+                       static_cast<int32_t>(position.y()));
         for (auto pointer : focus.devices) {
             pointer->motion(focus.transformation.map(position));
         }
@@ -244,6 +252,11 @@ void pointer_pool::button_pressed(uint32_t button)
         return;
     }
     if (focus.surface) {
+        WRAPLAND_PROBE(pointer_button,
+                       Wayland::probe_pid(focus.surface),
+                       Wayland::probe_id(focus.surface),
+                       button,
+                       1);
         for (auto pointer : focus.devices) {
             pointer->buttonPressed(serial, button);
         }
@@ -274,6 +287,11 @@ void pointer_pool::button_released(uint32_t button)
         return;
     }
     if (focus.surface) {
+        WRAPLAND_PROBE(pointer_button,
+                       Wayland::probe_pid(focus.surface),
+                       Wayland::probe_id(focus.surface),
+                       button,
+                       0);
         for (auto pointer : focus.devices) {
             pointer->buttonReleased(serial, button);
         }
@@ -318,6 +336,11 @@ void pointer_pool::send_axis(Qt::Orientation orientation,
         return;
     }
     if (focus.surface) {
+        WRAPLAND_PROBE(pointer_axis,
+                       Wayland::probe_pid(focus.surface),
+                       Wayland::probe_id(focus.surface),
+                       static_cast<int32_t>(orientation),
+                       discreteDelta);
         for (auto pointer : focus.devices) {
             pointer->axis(orientation, delta, discreteDelta, source);
         }
@@ -331,6 +354,11 @@ void pointer_pool::send_axis(Qt::Orientation orientation, uint32_t delta) const
         return;
     }
     if (focus.surface) {
+        WRAPLAND_PROBE(pointer_axis,
+                       Wayland::probe_pid(focus.surface),
+                       Wayland::probe_id(focus.surface),
+                       static_cast<int32_t>(orientation),
+                       0);
         for (auto pointer : focus.devices) {
             pointer->axis(orientation, delta);
         }
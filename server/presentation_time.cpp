@@ -26,6 +26,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "wl_output_p.h"
 
 #include "wayland/global.h"
+#include "wayland/object_pool.h"
 #include "wayland/resource.h"
 
 #include <wayland-presentation-time-server-protocol.h>
@@ -101,7 +102,9 @@ void PresentationManager::setClockId(clockid_t clockId)
     d_ptr->send<wp_presentation_send_clock_id>(clockId);
 }
 
-class PresentationFeedback::Private : public Wayland::Resource<PresentationFeedback>
+class PresentationFeedback::Private
+    : public Wayland::Resource<PresentationFeedback>
+    , public Wayland::pooled<PresentationFeedback::Private>
 {
 public:
     Private(Client* client, uint32_t version, uint32_t id, PresentationFeedback* q_ptr);
@@ -135,9 +138,19 @@ PresentationFeedback::~PresentationFeedback()
     }
 }
 
+void* PresentationFeedback::operator new(std::size_t size)
+{
+    return Wayland::object_pool<PresentationFeedback>::allocate(size);
+}
+
+void PresentationFeedback::operator delete(void* ptr, std::size_t size)
+{
+    Wayland::object_pool<PresentationFeedback>::deallocate(ptr, size);
+}
+
 void PresentationFeedback::sync(Server::output* output)
 {
-    auto outputBinds = output->wayland_output()->d_ptr->getBinds(d_ptr->client->handle);
+    auto const& outputBinds = output->wayland_output()->d_ptr->getBinds(d_ptr->client->handle);
 
     for (auto bind : outputBinds) {
         d_ptr->send<wp_presentation_feedback_send_sync_output>(bind->resource);
@@ -63,6 +63,10 @@ public:
 
     ~PresentationFeedback() override;
 
+    // Objects are created per request and come from a pool.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
     void sync(Server::output* output);
     void presented(uint32_t tvSecHi,
                    uint32_t tvSecLo,
@@ -0,0 +1,611 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include "rect_region.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace Wrapland::Server
+{
+
+namespace
+{
+
+using box = rect_region::box;
+using span = rect_region::span;
+using band = rect_region::band;
+
+int clamp_to_int(int64_t value)
+{
+    return static_cast<int>(std::clamp<int64_t>(
+        value, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()));
+}
+
+box to_box(QRect const& rect)
+{
+    // Clients send huge rectangles to mean everything. Their far edges must not overflow.
+    return {rect.x(),
+            rect.y(),
+            clamp_to_int(int64_t{rect.x()} + rect.width()),
+            clamp_to_int(int64_t{rect.y()} + rect.height())};
+}
+
+bool box_empty(box const& box)
+{
+    return box.x1 >= box.x2 || box.y1 >= box.y2;
+}
+
+bool box_overlaps(box const& lhs, box const& rhs)
+{
+    return lhs.x1 < rhs.x2 && rhs.x1 < lhs.x2 && lhs.y1 < rhs.y2 && rhs.y1 < lhs.y2;
+}
+
+bool box_contains(box const& outer, box const& inner)
+{
+    return outer.x1 <= inner.x1 && outer.y1 <= inner.y1 && inner.x2 <= outer.x2
+        && inner.y2 <= outer.y2;
+}
+
+/// Bands of a region, with the single rectangle case mapped to one band of one span.
+struct band_list {
+    band const* bands{nullptr};
+    size_t count{0};
+    span const* spans{nullptr};
+
+    band single_band{};
+    span single_span{};
+
+    band_list(box const& extents, std::vector<band> const& bands, std::vector<span> const& spans)
+    {
+        if (!bands.empty()) {
+            this->bands = bands.data();
+            this->count = bands.size();
+            this->spans = spans.data();
+            return;
+        }
+        if (box_empty(extents)) {
+            return;
+        }
+        single_band = {extents.y1, extents.y2, 0, 1};
+        single_span = {extents.x1, extents.x2};
+        this->bands = &single_band;
+        this->count = 1;
+        this->spans = &single_span;
+    }
+
+    band_list(band_list const&) = delete;
+    band_list& operator=(band_list const&) = delete;
+    band_list(band_list&&) noexcept = delete;
+    band_list& operator=(band_list&&) noexcept = delete;
+    ~band_list() = default;
+};
+
+void unite_spans(span const* lhs,
+                 span const* lhs_end,
+                 span const* rhs,
+                 span const* rhs_end,
+                 std::vector<span>& out,
+                 size_t out_begin)
+{
+    while (lhs != lhs_end || rhs != rhs_end) {
+        span next;
+        if (rhs == rhs_end || (lhs != lhs_end && lhs->x1 <= rhs->x1)) {
+            next = *lhs++;
+        } else {
+            next = *rhs++;
+        }
+
+        if (out.size() > out_begin && out.back().x2 >= next.x1) {
+            out.back().x2 = std::max(out.back().x2, next.x2);
+        } else {
+            out.push_back(next);
+        }
+    }
+}
+
+void intersect_spans(span const* lhs,
+                     span const* lhs_end,
+                     span const* rhs,
+                     span const* rhs_end,
+                     std::vector<span>& out)
+{
+    while (lhs != lhs_end && rhs != rhs_end) {
+        auto const x1 = std::max(lhs->x1, rhs->x1);
+        auto const x2 = std::min(lhs->x2, rhs->x2);
+        if (x1 < x2) {
+            out.push_back({x1, x2});
+        }
+        if (lhs->x2 < rhs->x2) {
+            lhs++;
+        } else {
+            rhs++;
+        }
+    }
+}
+
+void subtract_spans(span const* lhs,
+                    span const* lhs_end,
+                    span const* rhs,
+                    span const* rhs_end,
+                    std::vector<span>& out)
+{
+    for (; lhs != lhs_end; lhs++) {
+        auto x1 = lhs->x1;
+
+        while (rhs != rhs_end && rhs->x2 <= x1) {
+            rhs++;
+        }
+
+        for (auto cut = rhs; cut != rhs_end && cut->x1 < lhs->x2; cut++) {
+            if (cut->x1 > x1) {
+                out.push_back({x1, cut->x1});
+            }
+            x1 = std::max(x1, cut->x2);
+            if (x1 >= lhs->x2) {
+                break;
+            }
+        }
+
+        if (x1 < lhs->x2) {
+            out.push_back({x1, lhs->x2});
+        }
+    }
+}
+
+}
+
+rect_region::rect_region(QRect const& rect)
+    : m_extents{to_box(rect)}
+{
+    if (box_empty(m_extents)) {
+        m_extents = {};
+    }
+}
+
+rect_region::rect_region(QRegion const& region)
+{
+    if (region.rectCount() <= 1) {
+        *this = rect_region(region.boundingRect());
+        return;
+    }
+
+    m_spans.reserve(static_cast<size_t>(region.rectCount()));
+
+    // QRegion stores its rectangles in the same banded order.
+    int y1{0};
+    int y2{0};
+    size_t spans_begin{0};
+
+    for (auto const& rect : region) {
+        auto const rect_box = to_box(rect);
+        if (rect_box.y1 != y1 || rect_box.y2 != y2) {
+            if (m_spans.size() > spans_begin) {
+                append_band(y1, y2, spans_begin);
+            }
+            y1 = rect_box.y1;
+            y2 = rect_box.y2;
+            spans_begin = m_spans.size();
+        }
+        m_spans.push_back({rect_box.x1, rect_box.x2});
+    }
+    if (m_spans.size() > spans_begin) {
+        append_band(y1, y2, spans_begin);
+    }
+
+    finalize();
+}
+
+rect_region rect_region::from_rects(std::vector<QRect> const& rects)
+{
+    // Pairwise unions keep every step balanced instead of growing one region rect by rect.
+    std::vector<rect_region> regions;
+    regions.reserve(rects.size());
+    for (auto const& rect : rects) {
+        rect_region region(rect);
+        if (!region.empty()) {
+            regions.push_back(std::move(region));
+        }
+    }
+
+    if (regions.empty()) {
+        return {};
+    }
+
+    while (regions.size() > 1) {
+        size_t out{0};
+        for (size_t index = 0; index + 1 < regions.size(); index += 2) {
+            regions[out] = combine(regions[index], regions[index + 1], op::unite);
+            out++;
+        }
+        if (regions.size() % 2 == 1) {
+            regions[out] = std::move(regions.back());
+            out++;
+        }
+        regions.resize(out);
+    }
+
+    return std::move(regions.front());
+}
+
+bool rect_region::empty() const
+{
+    return box_empty(m_extents);
+}
+
+QRect rect_region::bounding_rect() const
+{
+    if (empty()) {
+        return {};
+    }
+    return {m_extents.x1, m_extents.y1, m_extents.x2 - m_extents.x1, m_extents.y2 - m_extents.y1};
+}
+
+size_t rect_region::rect_count() const
+{
+    if (m_bands.empty()) {
+        return empty() ? 0 : 1;
+    }
+    return m_spans.size();
+}
+
+bool rect_region::contains(QPoint const& point) const
+{
+    auto const x = point.x();
+    auto const y = point.y();
+
+    if (x < m_extents.x1 || x >= m_extents.x2 || y < m_extents.y1 || y >= m_extents.y2) {
+        return false;
+    }
+    if (m_bands.empty()) {
+        return true;
+    }
+
+    auto const band_it = std::upper_bound(
+        m_bands.cbegin(), m_bands.cend(), y, [](int y, auto const& band) { return y < band.y2; });
+    if (band_it == m_bands.cend() || band_it->y1 > y) {
+        return false;
+    }
+
+    auto const spans_begin = m_spans.cbegin() + band_it->begin;
+    auto const spans_end = m_spans.cbegin() + band_it->end;
+    auto const span_it = std::upper_bound(
+        spans_begin, spans_end, x, [](int x, auto const& span) { return x < span.x2; });
+    return span_it != spans_end && span_it->x1 <= x;
+}
+
+void rect_region::unite(rect_region const& other)
+{
+    if (other.empty() || this == &other) {
+        return;
+    }
+    if (empty()) {
+        *this = other;
+        return;
+    }
+
+    if (m_bands.empty() && box_contains(m_extents, other.m_extents)) {
+        return;
+    }
+    if (other.m_bands.empty() && box_contains(other.m_extents, m_extents)) {
+        *this = other;
+        return;
+    }
+
+    *this = combine(*this, other, op::unite);
+}
+
+void rect_region::unite(QRect const& rect)
+{
+    unite(rect_region(rect));
+}
+
+void rect_region::intersect(rect_region const& other)
+{
+    if (empty() || this == &other) {
+        return;
+    }
+    if (!box_overlaps(m_extents, other.m_extents)) {
+        clear();
+        return;
+    }
+
+    if (m_bands.empty() && other.m_bands.empty()) {
+        m_extents = {std::max(m_extents.x1, other.m_extents.x1),
+                     std::max(m_extents.y1, other.m_extents.y1),
+                     std::min(m_extents.x2, other.m_extents.x2),
+                     std::min(m_extents.y2, other.m_extents.y2)};
+        return;
+    }
+    if (other.m_bands.empty() && box_contains(other.m_extents, m_extents)) {
+        return;
+    }
+
+    *this = combine(*this, other, op::intersect);
+}
+
+void rect_region::intersect(QRect const& rect)
+{
+    intersect(rect_region(rect));
+}
+
+void rect_region::subtract(rect_region const& other)
+{
+    if (empty() || other.empty()) {
+        return;
+    }
+    if (this == &other) {
+        clear();
+        return;
+    }
+    if (!box_overlaps(m_extents, other.m_extents)) {
+        return;
+    }
+    if (other.m_bands.empty() && box_contains(other.m_extents, m_extents)) {
+        clear();
+        return;
+    }
+
+    *this = combine(*this, other, op::subtract);
+}
+
+void rect_region::subtract(QRect const& rect)
+{
+    subtract(rect_region(rect));
+}
+
+void rect_region::translate(QPoint const& offset)
+{
+    if (empty()) {
+        return;
+    }
+
+    auto const dx = offset.x();
+    auto const dy = offset.y();
+
+    m_extents.x1 += dx;
+    m_extents.x2 += dx;
+    m_extents.y1 += dy;
+    m_extents.y2 += dy;
+
+    // Plain loops over the arrays. They vectorize.
+    for (auto& band : m_bands) {
+        band.y1 += dy;
+        band.y2 += dy;
+    }
+    for (auto& span : m_spans) {
+        span.x1 += dx;
+        span.x2 += dx;
+    }
+}
+
+void rect_region::scale(double factor)
+{
+    if (empty() || factor == 1.) {
+        return;
+    }
+    if (factor <= 0.) {
+        clear();
+        return;
+    }
+
+    auto const down = [factor](int value) {
+        return clamp_to_int(static_cast<int64_t>(std::floor(value * factor)));
+    };
+    auto const up = [factor](int value) {
+        return clamp_to_int(static_cast<int64_t>(std::ceil(value * factor)));
+    };
+
+    auto const integral = factor >= 1. && factor == std::floor(factor);
+
+    if (m_bands.empty() || integral) {
+        // Scaling by whole numbers keeps bands and spans apart. No rebuild is needed.
+        m_extents = {down(m_extents.x1), down(m_extents.y1), up(m_extents.x2), up(m_extents.y2)};
+        for (auto& band : m_bands) {
+            band.y1 = down(band.y1);
+            band.y2 = up(band.y2);
+        }
+        for (auto& span : m_spans) {
+            span.x1 = down(span.x1);
+            span.x2 = up(span.x2);
+        }
+        return;
+    }
+
+    // Rounding outwards may let rectangles overlap.
+    std::vector<QRect> rects;
+    rects.reserve(rect_count());
+    for_each_rect([&](auto const& rect) {
+        auto const rect_box = to_box(rect);
+        auto const x1 = down(rect_box.x1);
+        auto const y1 = down(rect_box.y1);
+        rects.emplace_back(x1, y1, up(rect_box.x2) - x1, up(rect_box.y2) - y1);
+    });
+    *this = from_rects(rects);
+}
+
+void rect_region::clear()
+{
+    m_extents = {};
+    m_bands.clear();
+    m_spans.clear();
+}
+
+QRegion rect_region::to_qregion() const
+{
+    if (m_bands.empty()) {
+        return QRegion(bounding_rect());
+    }
+
+    std::vector<QRect> rects;
+    rects.reserve(m_spans.size());
+    for_each_rect([&rects](auto const& rect) { rects.push_back(rect); });
+
+    // The bands are in the order QRegion keeps its rectangles, so they are taken over as is.
+    QRegion region;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    region.setRects(QSpan<QRect const>(rects));
+#else
+    region.setRects(rects.data(), static_cast<int>(rects.size()));
+#endif
+    return region;
+}
+
+bool rect_region::operator==(rect_region const& other) const
+{
+    auto const box_equal = [](box const& lhs, box const& rhs) {
+        return lhs.x1 == rhs.x1 && lhs.y1 == rhs.y1 && lhs.x2 == rhs.x2 && lhs.y2 == rhs.y2;
+    };
+
+    if (!box_equal(m_extents, other.m_extents) || m_bands.size() != other.m_bands.size()
+        || m_spans.size() != other.m_spans.size()) {
+        return false;
+    }
+
+    // Spans are compared in order, so band ranges match when the spans do.
+    return std::equal(m_bands.cbegin(),
+                      m_bands.cend(),
+                      other.m_bands.cbegin(),
+                      [](auto const& lhs, auto const& rhs) {
+                          return lhs.y1 == rhs.y1 && lhs.y2 == rhs.y2 && lhs.end == rhs.end;
+                      })
+        && std::equal(m_spans.cbegin(),
+                      m_spans.cend(),
+                      other.m_spans.cbegin(),
+                      [](auto const& lhs, auto const& rhs) {
+                          return lhs.x1 == rhs.x1 && lhs.x2 == rhs.x2;
+                      });
+}
+
+rect_region rect_region::combine(rect_region const& lhs, rect_region const& rhs, op operation)
+{
+    band_list const lhs_bands(lhs.m_extents, lhs.m_bands, lhs.m_spans);
+    band_list const rhs_bands(rhs.m_extents, rhs.m_bands, rhs.m_spans);
+
+    rect_region result;
+    auto const capacity = std::max(lhs.m_spans.size(), rhs.m_spans.size()) + 1;
+    result.m_spans.reserve(operation == op::unite ? 2 * capacity : capacity);
+    result.m_bands.reserve(std::max(lhs.m_bands.size(), rhs.m_bands.size()) + 1);
+
+    size_t lhs_index{0};
+    size_t rhs_index{0};
+
+    auto y = std::numeric_limits<int>::max();
+    if (lhs_bands.count > 0) {
+        y = lhs_bands.bands[0].y1;
+    }
+    if (rhs_bands.count > 0) {
+        y = std::min(y, rhs_bands.bands[0].y1);
+    }
+
+    // Sweep from top to bottom over the intervals in which neither region changes its spans.
+    while (lhs_index < lhs_bands.count || rhs_index < rhs_bands.count) {
+        auto const lhs_band = lhs_index < lhs_bands.count ? &lhs_bands.bands[lhs_index] : nullptr;
+        auto const rhs_band = rhs_index < rhs_bands.count ? &rhs_bands.bands[rhs_index] : nullptr;
+
+        auto const lhs_in = lhs_band && lhs_band->y1 <= y;
+        auto const rhs_in = rhs_band && rhs_band->y1 <= y;
+
+        auto next = std::numeric_limits<int>::max();
+        if (lhs_band) {
+            next = std::min(next, lhs_in ? lhs_band->y2 : lhs_band->y1);
+        }
+        if (rhs_band) {
+            next = std::min(next, rhs_in ? rhs_band->y2 : rhs_band->y1);
+        }
+
+        if (lhs_in || rhs_in) {
+            auto const spans_begin = result.m_spans.size();
+
+            auto const lhs_spans = lhs_in ? lhs_bands.spans + lhs_band->begin : nullptr;
+            auto const lhs_end = lhs_in ? lhs_bands.spans + lhs_band->end : nullptr;
+            auto const rhs_spans = rhs_in ? rhs_bands.spans + rhs_band->begin : nullptr;
+            auto const rhs_end = rhs_in ? rhs_bands.spans + rhs_band->end : nullptr;
+
+            switch (operation) {
+            case op::unite:
+                unite_spans(lhs_spans, lhs_end, rhs_spans, rhs_end, result.m_spans, spans_begin);
+                break;
+            case op::intersect:
+                intersect_spans(lhs_spans, lhs_end, rhs_spans, rhs_end, result.m_spans);
+                break;
+            case op::subtract:
+                subtract_spans(lhs_spans, lhs_end, rhs_spans, rhs_end, result.m_spans);
+                break;
+            }
+
+            if (result.m_spans.size() > spans_begin) {
+                result.append_band(y, next, spans_begin);
+            }
+        }
+
+        y = next;
+        if (lhs_band && lhs_band->y2 == y) {
+            lhs_index++;
+        }
+        if (rhs_band && rhs_band->y2 == y) {
+            rhs_index++;
+        }
+    }
+
+    result.finalize();
+    return result;
+}
+
+void rect_region::append_band(int y1, int y2, size_t spans_begin)
+{
+    auto const spans_end = m_spans.size();
+    assert(spans_end > spans_begin);
+
+    if (!m_bands.empty()) {
+        auto& last = m_bands.back();
+        auto const last_count = last.end - last.begin;
+
+        if (last.y2 == y1 && last_count == spans_end - spans_begin
+            && std::equal(m_spans.cbegin() + last.begin,
+                          m_spans.cbegin() + last.end,
+                          m_spans.cbegin() + static_cast<std::ptrdiff_t>(spans_begin),
+                          [](auto const& lhs, auto const& rhs) {
+                              return lhs.x1 == rhs.x1 && lhs.x2 == rhs.x2;
+                          })) {
+            // Same spans as the band above. Extend that one instead.
+            last.y2 = y2;
+            m_spans.resize(spans_begin);
+            return;
+        }
+    }
+
+    m_bands.push_back(
+        {y1, y2, static_cast<uint32_t>(spans_begin), static_cast<uint32_t>(spans_end)});
+}
+
+void rect_region::finalize()
+{
+    if (m_bands.empty()) {
+        clear();
+        return;
+    }
+
+    m_extents.y1 = m_bands.front().y1;
+    m_extents.y2 = m_bands.back().y2;
+    m_extents.x1 = std::numeric_limits<int>::max();
+    m_extents.x2 = std::numeric_limits<int>::min();
+
+    for (auto const& band : m_bands) {
+        m_extents.x1 = std::min(m_extents.x1, m_spans[band.begin].x1);
+        m_extents.x2 = std::max(m_extents.x2, m_spans[band.end - 1].x2);
+    }
+
+    if (m_bands.size() == 1 && m_spans.size() == 1) {
+        m_bands.clear();
+        m_spans.clear();
+    }
+}
+
+}
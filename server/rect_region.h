@@ -0,0 +1,117 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include <QPoint>
+#include <QRect>
+#include <QRegion>
+
+#include <cstdint>
+#include <vector>
+
+namespace Wrapland::Server
+{
+
+/**
+ * Region for the geometry computed by the server on commits, like damage, opaque and input areas.
+ * QRegion is only used at the public API.
+ *
+ * The region is stored as bands of equal height sorted from top to bottom. Each band holds the
+ * sorted, disjoint horizontal spans covered in it. Bands and spans lie in two flat arrays, so the
+ * set operations walk contiguous memory and translating touches each coordinate once in a loop
+ * the compiler can vectorize. A region of a single rectangle, the most common case by far,
+ * does not allocate at all.
+ *
+ * Bands with the same spans are always merged with their neighbors, so equal regions have equal
+ * representations.
+ */
+class rect_region
+{
+public:
+    rect_region() = default;
+    explicit rect_region(QRect const& rect);
+    explicit rect_region(QRegion const& region);
+
+    static rect_region from_rects(std::vector<QRect> const& rects);
+
+    bool empty() const;
+    QRect bounding_rect() const;
+    size_t rect_count() const;
+
+    bool contains(QPoint const& point) const;
+
+    void unite(rect_region const& other);
+    void unite(QRect const& rect);
+    void intersect(rect_region const& other);
+    void intersect(QRect const& rect);
+    void subtract(rect_region const& other);
+    void subtract(QRect const& rect);
+
+    void translate(QPoint const& offset);
+    /// Scales by @arg factor. Partially covered pixels are included, so damage is never lost.
+    void scale(double factor);
+
+    void clear();
+
+    QRegion to_qregion() const;
+
+    template<typename F>
+    void for_each_rect(F const& func) const
+    {
+        if (m_bands.empty()) {
+            if (!empty()) {
+                func(bounding_rect());
+            }
+            return;
+        }
+        for (auto const& band : m_bands) {
+            for (auto index = band.begin; index < band.end; index++) {
+                auto const& span = m_spans[index];
+                func(QRect(span.x1, band.y1, span.x2 - span.x1, band.y2 - band.y1));
+            }
+        }
+    }
+
+    bool operator==(rect_region const& other) const;
+
+    struct box {
+        int x1{0};
+        int y1{0};
+        int x2{0};
+        int y2{0};
+    };
+
+    struct span {
+        int x1;
+        int x2;
+    };
+
+    struct band {
+        int y1;
+        int y2;
+        // Range of spans in the span array.
+        uint32_t begin;
+        uint32_t end;
+    };
+
+private:
+    enum class op {
+        unite,
+        intersect,
+        subtract,
+    };
+
+    static rect_region combine(rect_region const& lhs, rect_region const& rhs, op operation);
+    void append_band(int y1, int y2, size_t spans_begin);
+    void finalize();
+
+    // Single rectangle regions have no bands and spans, the extents are the region then.
+    box m_extents;
+    std::vector<band> m_bands;
+    std::vector<span> m_spans;
+};
+
+}
@@ -21,20 +21,31 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "compositor.h"
 #include "display.h"
+#include "rect_region.h"
 
+#include "wayland/object_pool.h"
 #include "wayland/resource.h"
 
+#include <QMetaMethod>
+
+#include <optional>
 #include <wayland-server.h>
 
 namespace Wrapland::Server
 {
 
-class Region::Private : public Wayland::Resource<Region>
+class Region::Private
+    : public Wayland::Resource<Region>
+    , public Wayland::pooled<Region::Private>
 {
 public:
     Private(Client* client, uint32_t version, uint32_t id, Region* q_ptr);
 
-    QRegion qtRegion;
+    void changed();
+
+    rect_region region;
+    // Converted on first use after a change. Surfaces copy it once on commit.
+    std::optional<QRegion> qregion;
 
 private:
     static void addCallback(wl_client* wlClient,
@@ -73,8 +84,8 @@ void Region::Private::addCallback([[maybe_unused]] wl_client* client,
 {
     auto priv = get_handle(wlResource)->d_ptr;
 
-    priv->qtRegion = priv->qtRegion.united(QRect(pos_x, pos_y, width, height));
-    Q_EMIT priv->handle->regionChanged(priv->qtRegion);
+    priv->region.unite(QRect(pos_x, pos_y, width, height));
+    priv->changed();
 }
 
 void Region::Private::subtractCallback([[maybe_unused]] wl_client* wlClient,
@@ -86,11 +97,21 @@ void Region::Private::subtractCallback([[maybe_unused]] wl_client* wlClient,
 {
     auto priv = get_handle(wlResource)->d_ptr;
 
-    if (priv->qtRegion.isEmpty()) {
+    if (priv->region.empty()) {
         return;
     }
-    priv->qtRegion = priv->qtRegion.subtracted(QRect(pos_x, pos_y, width, height));
-    Q_EMIT priv->handle->regionChanged(priv->qtRegion);
+    priv->region.subtract(QRect(pos_x, pos_y, width, height));
+    priv->changed();
+}
+
+void Region::Private::changed()
+{
+    qregion.reset();
+
+    // Only convert the region per request when someone listens.
+    if (handle->isSignalConnected(QMetaMethod::fromSignal(&Region::regionChanged))) {
+        Q_EMIT handle->regionChanged(handle->region());
+    }
 }
 
 Region::Region(Client* client, uint32_t version, uint32_t id)
@@ -99,9 +120,22 @@ Region::Region(Client* client, uint32_t version, uint32_t id)
 {
 }
 
+void* Region::operator new(std::size_t size)
+{
+    return Wayland::object_pool<Region>::allocate(size);
+}
+
+void Region::operator delete(void* ptr, std::size_t size)
+{
+    Wayland::object_pool<Region>::deallocate(ptr, size);
+}
+
 QRegion Region::region() const
 {
-    return d_ptr->qtRegion;
+    if (!d_ptr->qregion) {
+        d_ptr->qregion = d_ptr->region.to_qregion();
+    }
+    return *d_ptr->qregion;
 }
 
 Client* Region::client() const
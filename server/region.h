@@ -36,6 +36,10 @@ public:
     QRegion region() const;
     Client* client() const;
 
+    // Objects are created per request and come from a pool.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
 Q_SIGNALS:
     void regionChanged(QRegion const&);
     void resourceDestroyed();
@@ -27,6 +27,8 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "primary_selection.h"
 #include "surface.h"
 
+#include "wayland/display.h"
+
 #include <config-wrapland.h>
 #include <cstdint>
 
@@ -43,9 +45,11 @@ Seat::Private::Private(Seat* q_ptr, Display* display)
     , data_devices{q_ptr}
     , primary_selection_devices{q_ptr}
     , text_inputs{q_ptr}
+    , idle{Wayland::Display::backendCast(display)->timer_wheel()}
     , q_ptr{q_ptr}
 {
     display->globals.seats.push_back(q_ptr);
+    idle.set_inhibited(Wayland::Display::backendCast(display)->idle_inhibiting_surfaces > 0);
 }
 
 Seat::Private::~Private()
@@ -238,9 +242,25 @@ void Seat::setTimestamp(uint32_t time)
         return;
     }
     d_ptr->timestamp = time;
+    d_ptr->idle.activity();
     Q_EMIT timestampChanged(time);
 }
 
+void Seat::set_idle_tracking(bool enable)
+{
+    d_ptr->idle.set_enabled(enable);
+}
+
+bool Seat::idle_tracking() const
+{
+    return d_ptr->idle.enabled();
+}
+
+void Seat::notify_activity()
+{
+    d_ptr->idle.activity();
+}
+
 void Seat::setFocusedKeyboardSurface(Surface* surface)
 {
     assert(hasKeyboard());
@@ -83,6 +83,19 @@ public:
     void setTimestamp(uint32_t time);
     uint32_t timestamp() const;
 
+    /**
+     * Let the seat send idle and resumed events to the idle notifications and timeouts created
+     * for it. Setting a new timestamp counts as user activity, other activity can be reported
+     * through notify_activity. Surfaces that inhibit idle hold the timeouts off while they are
+     * on an output.
+     *
+     * Disabled by default. The compositor then has to call idle and resume on the notifications
+     * by itself.
+     */
+    void set_idle_tracking(bool enable);
+    bool idle_tracking() const;
+    void notify_activity();
+
     void setFocusedKeyboardSurface(Surface* surface);
 
     input_method_v2* get_input_method_v2() const;
@@ -117,6 +130,9 @@ private:
     friend class data_control_manager_v1;
     friend class data_device_manager;
     friend class drag_pool;
+    friend class idle_notification_v1;
+    friend class idle_tracker;
+    friend class kde_idle_timeout;
     friend class keyboard_pool;
     friend class pointer_pool;
     friend class primary_selection_device_manager;
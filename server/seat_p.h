@@ -22,6 +22,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "seat.h"
 
 #include "drag_pool.h"
+#include "idle_tracker.h"
 #include "keyboard_pool.h"
 #include "pointer_pool.h"
 #include "selection_pool.h"
@@ -96,6 +97,8 @@ public:
     input_method_v2* input_method{nullptr};
     text_input_pool text_inputs;
 
+    idle_tracker idle;
+
     Seat* q_ptr;
 
 private:
@@ -154,6 +154,7 @@ void Subsurface::Private::applyCached(bool force)
         scheduledPosChange = false;
         pos = scheduledPos;
         scheduledPos = QPoint();
+        surface->d_ptr->invalidate_trees(surface_change::children);
         Q_EMIT handle->positionChanged(pos);
     }
 
@@ -174,9 +175,7 @@ void Subsurface::Private::commit()
 
     if (handle->isSynchronized()) {
         // Sync mode. We cache the pending state and wait for the parent surface to commit.
-        cached = std::move(surface->d_ptr->pending);
-        surface->d_ptr->pending = SurfaceState();
-        surface->d_ptr->pending.pub.children = cached.pub.children;
+        surface->d_ptr->merge_state(cached, surface->d_ptr->pending);
         if (cached.pub.buffer) {
             cached.pub.buffer->setCommitted();
         }
@@ -29,6 +29,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "contrast.h"
 #include "idle_inhibit_v1.h"
 #include "idle_inhibit_v1_p.h"
+#include "idle_tracker.h"
 #include "layer_shell_v1_p.h"
 #include "pointer_constraints_v1.h"
 #include "pointer_constraints_v1_p.h"
@@ -42,6 +43,9 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "wl_output_p.h"
 #include "xdg_shell_surface_p.h"
 
+#include "wayland/display.h"
+#include "wayland/probes.h"
+
 #include <QListIterator>
 
 #include <algorithm>
@@ -52,8 +56,40 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 namespace Wrapland::Server
 {
 
+namespace
+{
+
+[[maybe_unused]] int64_t probe_damage_area(damage_list const& damage)
+{
+    int64_t area{0};
+    damage.for_each(
+        [&area](auto const& rect) { area += static_cast<int64_t>(rect.width()) * rect.height(); });
+    return area;
+}
+
+bool swaps_axes(output_transform transform)
+{
+    using ot = output_transform;
+    return transform == ot::rotated_90 || transform == ot::rotated_270
+        || transform == ot::flipped_90 || transform == ot::flipped_270;
+}
+
+// Replacing the public damage allocates. Full damage of an unchanged size is the common case, so
+// the region is only replaced when it differs.
+void set_damage(QRegion& target, rect_region const& damage)
+{
+    if (damage.rect_count() == 1 && target.rectCount() == 1
+        && target.boundingRect() == damage.bounding_rect()) {
+        return;
+    }
+    target = damage.to_qregion();
+}
+
+}
+
 Surface::Private::Private(Client* client, uint32_t version, uint32_t id, Surface* q_ptr)
     : Wayland::Resource<Surface>(client, version, id, &wl_surface_interface, &s_interface, q_ptr)
+    , display{client->display()}
     , q_ptr{q_ptr}
 {
 }
@@ -76,17 +112,19 @@ Surface::Private::~Private()
         wl_resource_destroy(callback);
     }
 
+    invalidate_trees(surface_change::children);
+
     if (subsurface) {
         subsurface->d_ptr->surface = nullptr;
         subsurface = nullptr;
     }
 
-    for (auto child : current.pub.children) {
-        child->d_ptr->parent = nullptr;
-    }
-    for (auto child : pending.pub.children) {
-        child->d_ptr->parent = nullptr;
+    if (idle_inhibiting) {
+        idle_tracker::update_inhibition(*display, false);
     }
+    display->drop_deferred_event(wl_resource_get_client(resource), this);
+
+    detach_children();
 }
 
 void Surface::Private::addChild(Subsurface* child)
@@ -105,6 +143,14 @@ void Surface::Private::addChild(Subsurface* child)
 
 void Surface::Private::removeChild(Subsurface* child)
 {
+    if (display->tearing_down(wl_resource_get_client(resource))) {
+        // All surfaces of the client go away. Instead of updating the child lists and announcing
+        // the tree change for every single subsurface the remaining ones are detached at once.
+        detach_children();
+        invalidate_trees(surface_change::children);
+        return;
+    }
+
     if (subsurface) {
         auto& cached = subsurface->d_ptr->cached;
         cached.pub.children.erase(
@@ -118,6 +164,8 @@ void Surface::Private::removeChild(Subsurface* child)
         std::remove(current.pub.children.begin(), current.pub.children.end(), child),
         current.pub.children.end());
 
+    invalidate_trees(surface_change::children);
+
     // TODO(romangg): only emit that if the child was mapped.
     Q_EMIT handle->subsurfaceTreeChanged();
 
@@ -129,6 +177,22 @@ void Surface::Private::removeChild(Subsurface* child)
     }
 }
 
+void Surface::Private::detach_children()
+{
+    auto detach = [](auto& children) {
+        for (auto child : children) {
+            child->d_ptr->parent = nullptr;
+        }
+        children.clear();
+    };
+
+    if (subsurface) {
+        detach(subsurface->d_ptr->cached.pub.children);
+    }
+    detach(pending.pub.children);
+    detach(current.pub.children);
+}
+
 bool Surface::Private::raiseChild(Subsurface* subsurface, Surface* sibling)
 {
     auto it = std::find(pending.pub.children.begin(), pending.pub.children.end(), subsurface);
@@ -265,8 +329,11 @@ void Surface::Private::installViewport(Viewport* vp)
     });
 }
 
-void Surface::Private::addPresentationFeedback(PresentationFeedback* feedback) const
+void Surface::Private::addPresentationFeedback(PresentationFeedback* feedback)
 {
+    if (!pending.feedbacks) {
+        pending.feedbacks = std::make_unique<Feedbacks>();
+    }
     pending.feedbacks->add(feedback);
 }
 
@@ -340,14 +407,27 @@ void Surface::Private::installIdleInhibitor(IdleInhibitor* inhibitor)
     QObject::connect(inhibitor, &IdleInhibitor::resourceDestroyed, handle, [this, inhibitor] {
         idleInhibitors.removeOne(inhibitor);
         if (idleInhibitors.isEmpty()) {
+            update_idle_inhibition();
             Q_EMIT handle->inhibitsIdleChanged();
         }
     });
     if (idleInhibitors.count() == 1) {
+        update_idle_inhibition();
         Q_EMIT handle->inhibitsIdleChanged();
     }
 }
 
+void Surface::Private::update_idle_inhibition()
+{
+    auto const inhibiting = !idleInhibitors.isEmpty() && !outputs.empty();
+    if (idle_inhibiting == inhibiting) {
+        return;
+    }
+
+    idle_inhibiting = inhibiting;
+    idle_tracker::update_inhibition(*display, inhibiting);
+}
+
 const struct wl_surface_interface Surface::Private::s_interface = {
     destroyCallback,
     attachCallback,
@@ -376,17 +456,42 @@ surface_state const& Surface::state() const
 
 void Surface::frameRendered(quint32 msec)
 {
-    while (!d_ptr->current.callbacks.empty()) {
-        auto resource = d_ptr->current.callbacks.front();
-        d_ptr->current.callbacks.pop_front();
-        wl_callback_send_done(resource, msec);
-        wl_resource_destroy(resource);
-    }
+    d_ptr->frame_rendered(msec);
+
     for (auto& subsurface : d_ptr->current.pub.children) {
         subsurface->d_ptr->surface->frameRendered(msec);
     }
 }
 
+bool Surface::Private::frame_rendered(uint32_t msec)
+{
+    WRAPLAND_PROBE(frame_rendered, client->processId(), id(), msec, current.callbacks.size());
+
+    if (current.callbacks.empty()) {
+        return false;
+    }
+
+    if (display->coalescing(client->native)) {
+        // Done once the client reads again, with the newest frame time.
+        display->defer_event(client->native, this, [this, msec] { send_frame_done(msec); });
+        return false;
+    }
+
+    send_frame_done(msec);
+    return true;
+}
+
+void Surface::Private::send_frame_done(uint32_t msec)
+{
+    for (auto resource : current.callbacks) {
+        wl_callback_send_done(resource, msec);
+        // Removed from the list below at once instead of searching for it on destruction.
+        wl_resource_set_destructor(resource, nullptr);
+        wl_resource_destroy(resource);
+    }
+    current.callbacks.clear();
+}
+
 bool Surface::Private::has_role() const
 {
     auto const has_xdg_shell_role
@@ -426,10 +531,7 @@ void Surface::Private::soureRectangleContainCheck(Buffer const* buffer,
         return;
     }
     QSizeF bufferSize = buffer->size() / scale;
-
-    using ot = output_transform;
-    if (transform == ot::rotated_90 || transform == ot::rotated_270 || transform == ot::flipped_90
-        || transform == ot::flipped_270) {
+    if (swaps_axes(transform)) {
         bufferSize.transpose();
     }
 
@@ -451,9 +553,6 @@ void Surface::Private::synced_child_update()
 void Surface::Private::update_buffer(SurfaceState const& source, bool& resized)
 {
     if (!(source.pub.updates & surface_change::buffer)) {
-        // TODO(romangg): Should we set the pending damage even when no new buffer got attached?
-        current.pub.damage = {};
-        current.bufferDamage = {};
         return;
     }
 
@@ -482,58 +581,43 @@ void Surface::Private::update_buffer(SurfaceState const& source, bool& resized)
     current.pub.buffer->setCommitted();
 
     current.pub.offset = source.pub.offset;
-    current.pub.damage = source.pub.damage;
-    current.bufferDamage = source.bufferDamage;
-
     auto const newSize = current.pub.buffer->size();
     resized = newSize.isValid() && newSize != oldSize;
+}
 
-    if (current.pub.damage.isEmpty() && current.bufferDamage.isEmpty()) {
-        // No damage submitted yet for the new buffer.
-
-        // TODO(romangg): Does this mean size is not change, i.e. return false always?
+void Surface::Private::update_damage(SurfaceState const& source)
+{
+    if (!(source.pub.updates & surface_change::buffer) || !current.pub.buffer) {
+        // TODO(romangg): Should we set the pending damage even when no new buffer got attached?
+        current.pub.damage = {};
         return;
     }
 
-    auto const surfaceSize = handle->size();
-    auto const surfaceRegion = QRegion(0, 0, surfaceSize.width(), surfaceSize.height());
-    if (surfaceRegion.isEmpty()) {
+    if (source.surface_damage.empty() && source.buffer_damage.empty()) {
+        // No damage submitted yet for the new buffer.
+        current.pub.damage = {};
         return;
     }
 
-    auto bufferDamage = QRegion();
+    auto damage = source.surface_damage.region();
 
-    if (!current.bufferDamage.isEmpty()) {
-        auto const tr = current.pub.transform;
-        auto const sc = current.pub.scale;
-
-        using ot = output_transform;
-        if (tr == ot::rotated_90 || tr == ot::rotated_270 || tr == ot::flipped_90
-            || tr == ot::flipped_270) {
-
-            // Calculate transformed + scaled buffer damage.
-            for (auto const& rect : current.bufferDamage) {
-                auto const add
-                    = QRegion(rect.x() / sc, rect.y() / sc, rect.height() / sc, rect.width() / sc);
-                bufferDamage = bufferDamage.united(add);
-            }
-
-        } else if (sc != 1) {
-
-            // Calculate scaled buffer damage.
-            for (auto const& rect : current.bufferDamage) {
-                auto const add
-                    = QRegion(rect.x() / sc, rect.y() / sc, rect.width() / sc, rect.height() / sc);
-                bufferDamage = bufferDamage.united(add);
-            }
-
-        } else {
-            bufferDamage = current.bufferDamage;
-        }
+    auto const mapping = current_mapping();
+    if (!source.buffer_damage.empty()) {
+        damage.unite(mapping.map(source.buffer_damage));
     }
 
-    current.pub.damage = surfaceRegion.intersected(current.pub.damage.united(bufferDamage));
-    trackedDamage = trackedDamage.united(current.pub.damage);
+    damage.intersect(QRect(QPoint(), mapping.surface_size()));
+    set_damage(current.pub.damage, damage);
+    tracked_damage.unite(damage);
+}
+
+buffer_mapping Surface::Private::current_mapping() const
+{
+    return {current.pub.buffer ? current.pub.buffer->size() : QSize(),
+            current.pub.scale,
+            current.pub.transform,
+            current.pub.source_rectangle,
+            current.destinationSize};
 }
 
 void Surface::Private::copy_to_current(SurfaceState const& source, bool& resized)
@@ -607,6 +691,11 @@ void Surface::Private::copy_to_current(SurfaceState const& source, bool& resized
         current.pub.scale = source.pub.scale;
     }
     if (source.pub.updates & surface_change::transform) {
+        // Rotating by 90 or 270 degrees swaps width and height of the surface.
+        if (current.pub.buffer
+            && swaps_axes(current.pub.transform) != swaps_axes(source.pub.transform)) {
+            resized = true;
+        }
         current.pub.transform = source.pub.transform;
     }
 
@@ -643,6 +732,7 @@ void Surface::Private::updateCurrentState(SurfaceState& source, bool forceChildr
 
     update_buffer(source, resized);
     copy_to_current(source, resized);
+    update_damage(source);
 
     // Now check that source rectangle is (still) well defined.
     soureRectangleIntegerCheck(current.destinationSize, current.pub.source_rectangle);
@@ -665,16 +755,125 @@ void Surface::Private::updateCurrentState(SurfaceState& source, bool forceChildr
         current.pub.updates |= surface_change::size;
     }
 
+    // Feedbacks of the previous commit not locked for presentation are discarded with it.
     current.feedbacks = std::move(source.feedbacks);
 
-    source = SurfaceState();
-    source.pub.children = current.pub.children;
+    reset_state(source);
+
+    invalidate_trees(current.pub.updates);
 
     for (auto& subsurface : current.pub.children) {
         subsurface->d_ptr->applyCached(forceChildren);
     }
 }
 
+void Surface::Private::merge_state(SurfaceState& target, SurfaceState& source) const
+{
+    auto const updates = source.pub.updates;
+
+    if (updates & surface_change::buffer) {
+        target.pub.buffer = std::move(source.pub.buffer);
+        target.pub.offset = source.pub.offset;
+    }
+
+    auto const limit = display->damage_rect_limit();
+    source.surface_damage.for_each(
+        [&](auto const& rect) { target.surface_damage.add(rect, limit); });
+    source.buffer_damage.for_each(
+        [&](auto const& rect) { target.buffer_damage.add(rect, limit); });
+
+    if (updates & surface_change::children) {
+        target.pub.children = source.pub.children;
+    }
+    target.callbacks.insert(
+        target.callbacks.end(), source.callbacks.begin(), source.callbacks.end());
+
+    if (updates & surface_change::shadow) {
+        target.pub.shadow = source.pub.shadow;
+    }
+    if (updates & surface_change::blur) {
+        target.pub.blur = source.pub.blur;
+    }
+    if (updates & surface_change::contrast) {
+        target.pub.contrast = source.pub.contrast;
+    }
+    if (updates & surface_change::slide) {
+        target.pub.slide = source.pub.slide;
+    }
+    if (updates & surface_change::input) {
+        target.pub.input = source.pub.input;
+        target.pub.input_is_infinite = source.pub.input_is_infinite;
+    }
+    if (updates & surface_change::opaque) {
+        target.pub.opaque = source.pub.opaque;
+    }
+    if (updates & surface_change::scale) {
+        target.pub.scale = source.pub.scale;
+    }
+    if (updates & surface_change::transform) {
+        target.pub.transform = source.pub.transform;
+    }
+    if (updates & surface_change::source_rectangle) {
+        target.pub.source_rectangle = source.pub.source_rectangle;
+    }
+    if (source.destinationSizeIsSet) {
+        target.destinationSize = source.destinationSize;
+        target.destinationSizeIsSet = true;
+    }
+
+    // Like for the current state feedbacks of a replaced commit are discarded.
+    target.feedbacks = std::move(source.feedbacks);
+    target.pub.updates |= updates;
+
+    reset_state(source);
+}
+
+void Surface::Private::reset_state(SurfaceState& state)
+{
+    // The children are kept. They are always in sync with the current children after a commit.
+    state.pub.buffer.reset();
+    state.pub.updates = surface_change::none;
+    state.surface_damage.clear();
+    state.buffer_damage.clear();
+    state.callbacks.clear();
+    state.destinationSizeIsSet = false;
+    state.destinationSize = QSize();
+    state.feedbacks.reset();
+}
+
+void Surface::Private::invalidate_trees(surface_changes changes)
+{
+    auto const stacking = changes & (surface_change::mapped | surface_change::children);
+    if (!stacking
+        && !(changes
+             & (surface_change::buffer | surface_change::size | surface_change::opaque
+                | surface_change::input))) {
+        return;
+    }
+
+    auto priv = this;
+
+    while (priv) {
+        if (priv->tree) {
+            if (stacking) {
+                priv->tree->invalidate();
+            } else {
+                priv->tree->invalidate_surface(handle);
+            }
+        }
+        auto parent = priv->subsurface ? priv->subsurface->parentSurface() : nullptr;
+        priv = parent ? parent->d_ptr : nullptr;
+    }
+}
+
+surface_tree& Surface::Private::get_tree()
+{
+    if (!tree) {
+        tree = std::make_unique<surface_tree>(handle);
+    }
+    return *tree;
+}
+
 void Surface::Private::commit()
 {
     if (subsurface) {
@@ -683,6 +882,12 @@ void Surface::Private::commit()
         return;
     }
 
+    WRAPLAND_PROBE(surface_commit,
+                   client->processId(),
+                   id(),
+                   probe_damage_area(pending.surface_damage)
+                       + probe_damage_area(pending.buffer_damage));
+
     updateCurrentState(false);
 
     if (shellSurface) {
@@ -699,12 +904,12 @@ void Surface::Private::commit()
 
 void Surface::Private::damage(QRect const& rect)
 {
-    pending.pub.damage = pending.pub.damage.united(rect);
+    pending.surface_damage.add(rect, display->damage_rect_limit());
 }
 
 void Surface::Private::damageBuffer(QRect const& rect)
 {
-    pending.bufferDamage = pending.bufferDamage.united(rect);
+    pending.buffer_damage.add(rect, display->damage_rect_limit());
 }
 
 void Surface::Private::setScale(qint32 scale)
@@ -716,6 +921,7 @@ void Surface::Private::setScale(qint32 scale)
 void Surface::Private::setTransform(output_transform transform)
 {
     pending.pub.transform = transform;
+    pending.pub.updates |= surface_change::transform;
 }
 
 void Surface::Private::addFrameCallback(uint32_t callback)
@@ -740,26 +946,33 @@ void Surface::Private::attachBuffer(wl_resource* wlBuffer, QPoint const& offset)
     if (!wlBuffer) {
         // Got a null buffer, deletes content in next frame.
         pending.pub.buffer.reset();
-        pending.pub.damage = QRegion();
-        pending.bufferDamage = QRegion();
+        pending.surface_damage.clear();
+        pending.buffer_damage.clear();
         return;
     }
 
     pending.pub.buffer = Buffer::make(wlBuffer, q_ptr);
 
-    QObject::connect(pending.pub.buffer.get(),
-                     &Buffer::resourceDestroyed,
-                     handle,
-                     [this, buffer = pending.pub.buffer.get()]() {
-                         if (pending.pub.buffer.get() == buffer) {
-                             pending.pub.buffer.reset();
-                         } else if (current.pub.buffer.get() == buffer) {
-                             current.pub.buffer.reset();
-                         } else if (subsurface
-                                    && subsurface->d_ptr->cached.pub.buffer.get() == buffer) {
-                             subsurface->d_ptr->cached.pub.buffer.reset();
-                         }
-                     });
+    auto buffer = pending.pub.buffer.get();
+    if (buffer_destroy_notifiers.contains(buffer)) {
+        // Same wl_buffer attached before. Its server side object is reused.
+        return;
+    }
+
+    buffer_destroy_notifiers[buffer]
+        = QObject::connect(buffer, &Buffer::resourceDestroyed, handle, [this, buffer]() {
+              buffer_destroy_notifiers.erase(buffer);
+
+              if (pending.pub.buffer.get() == buffer) {
+                  pending.pub.buffer.reset();
+              }
+              if (current.pub.buffer.get() == buffer) {
+                  current.pub.buffer.reset();
+              }
+              if (subsurface && subsurface->d_ptr->cached.pub.buffer.get() == buffer) {
+                  subsurface->d_ptr->cached.pub.buffer.reset();
+              }
+          });
 }
 
 void Surface::Private::destroyFrameCallback(wl_resource* wlResource)
@@ -854,7 +1067,19 @@ void Surface::Private::setInput(QRegion const& region, bool isInfinite)
 void Surface::Private::commitCallback([[maybe_unused]] wl_client* wlClient, wl_resource* wlResource)
 {
     auto priv = get_handle(wlResource)->d_ptr;
+    auto display = priv->client->display();
+
+    Wayland::trace_record record;
+    record.start = Wayland::Trace::now();
+    record.interface = "wl_surface";
+    record.pid = priv->client->processId();
+    record.id = priv->id();
+    record.kind = Wayland::trace_kind::commit;
+
     priv->commit();
+
+    record.duration = Wayland::Trace::now() - record.start;
+    display->trace().record(record);
 }
 
 void Surface::Private::bufferTransformCallback([[maybe_unused]] wl_client* wlClient,
@@ -883,14 +1108,18 @@ QSize Surface::size() const
     if (!d_ptr->current.pub.buffer) {
         return {};
     }
-    if (d_ptr->current.destinationSize.isValid()) {
-        return d_ptr->current.destinationSize;
-    }
-    if (d_ptr->current.pub.source_rectangle.isValid()) {
-        return d_ptr->current.pub.source_rectangle.size().toSize();
-    }
-    // TODO(unknown author): Apply transform to the buffer size.
-    return d_ptr->current.pub.buffer->size() / d_ptr->current.pub.scale;
+    return d_ptr->current_mapping().surface_size();
+}
+
+surface_hit Surface::surface_at(QPointF const& pos) const
+{
+    return d_ptr->get_tree().surface_at(pos);
+}
+
+std::vector<surface_visibility> Surface::visible_regions(QPoint const& position,
+                                                         QRect const& clip) const
+{
+    return d_ptr->get_tree().visible_regions(clip.translated(-position));
 }
 
 QRect Surface::expanse() const
@@ -916,12 +1145,12 @@ bool Surface::isMapped() const
 
 QRegion Surface::trackedDamage() const
 {
-    return d_ptr->trackedDamage;
+    return d_ptr->tracked_damage.to_qregion();
 }
 
 void Surface::resetTrackedDamage()
 {
-    d_ptr->trackedDamage = QRegion();
+    d_ptr->tracked_damage.clear();
 }
 
 std::vector<WlOutput*> Surface::outputs() const
@@ -950,7 +1179,7 @@ void Surface::setOutputs(std::vector<WlOutput*> const& outputs)
     }
 
     for (auto output : removed_outputs) {
-        auto const binds = output->d_ptr->getBinds(d_ptr->client->handle);
+        auto const& binds = output->d_ptr->getBinds(d_ptr->client->handle);
         for (auto bind : binds) {
             d_ptr->send<wl_surface_send_leave>(bind->resource);
         }
@@ -964,7 +1193,7 @@ void Surface::setOutputs(std::vector<WlOutput*> const& outputs)
     }
 
     for (auto output : added_outputs) {
-        auto const binds = output->d_ptr->getBinds(d_ptr->client->handle);
+        auto const& binds = output->d_ptr->getBinds(d_ptr->client->handle);
         for (auto bind : binds) {
             d_ptr->send<wl_surface_send_enter>(bind->resource);
         }
@@ -992,6 +1221,7 @@ void Surface::setOutputs(std::vector<WlOutput*> const& outputs)
     // TODO(unknown author): send enter when the client binds the Output another time
 
     d_ptr->outputs = outputs;
+    d_ptr->update_idle_inhibition();
 }
 
 LockedPointerV1* Surface::lockedPointer() const
@@ -22,6 +22,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "output.h"
 
 #include <QObject>
+#include <QPointF>
 #include <QRegion>
 
 #include <Wrapland/Server/wraplandserver_export.h>
@@ -47,6 +48,7 @@ class ShadowManager;
 class Shadow;
 class Slide;
 class Subsurface;
+class Surface;
 class Viewport;
 class Viewporter;
 
@@ -96,6 +98,20 @@ struct surface_state {
     surface_changes updates{surface_change::none};
 };
 
+struct surface_hit {
+    Surface* surface{nullptr};
+    // In the local coordinates of the surface.
+    QPointF position;
+};
+
+struct surface_visibility {
+    Surface* surface{nullptr};
+    // Position of the surface relative to the root of the tree.
+    QPoint offset;
+    // Not covered by opaque content above, in the local coordinates of the surface.
+    QRegion region;
+};
+
 class WRAPLANDSERVER_EXPORT Surface : public QObject
 {
     Q_OBJECT
@@ -122,6 +138,28 @@ public:
 
     Subsurface* subsurface() const;
 
+    /**
+     * The topmost mapped surface in the tree of this surface and its subsurfaces with an input
+     * region containing @arg pos, relative to this surface. The position is in the pixel it lies
+     * in, so right and bottom edges are exclusive. Input regions are clipped to their surface.
+     *
+     * An index of the tree is kept and updated on commits. Walking the subsurfaces on every hit
+     * test is not needed.
+     */
+    surface_hit surface_at(QPointF const& pos) const;
+
+    /**
+     * Visible regions of this surface and its mapped subsurfaces in stacking order from the
+     * bottom, when this surface is placed at @arg position and shown inside @arg clip, for example
+     * an output's geometry. Opaque regions and buffers without alpha channel hide what is below
+     * them. Surfaces with an empty region are fully covered and do not need to be drawn.
+     *
+     * The result is cached. It is only computed again when the clip relative to this surface
+     * changes or when commits change the opaque regions, sizes, positions or stacking in the tree.
+     */
+    std::vector<surface_visibility> visible_regions(QPoint const& position,
+                                                    QRect const& clip) const;
+
     bool isMapped() const;
     QRegion trackedDamage() const;
     void resetTrackedDamage();
@@ -164,6 +202,7 @@ private:
     friend class ContrastManager;
     friend class Compositor;
     friend class data_device;
+    friend class Display;
     friend class Keyboard;
     friend class IdleInhibitManagerV1;
     friend class input_method_v2;
@@ -180,6 +219,7 @@ private:
     friend class ShadowManager;
     friend class SlideManager;
     friend class Subsurface;
+    friend class surface_tree;
     friend class text_input_v2;
     friend class text_input_v3;
     friend class Viewporter;
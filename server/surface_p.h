@@ -21,12 +21,15 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "surface.h"
 
+#include "buffer_mapping.h"
+#include "damage_list.h"
+#include "surface_tree.h"
+
 #include "wayland/resource.h"
 
 #include <QHash>
 #include <QVector>
 
-#include <deque>
 #include <functional>
 #include <unordered_map>
 #include <wayland-server.h>
@@ -54,15 +57,18 @@ public:
 
     surface_state pub;
 
-    QRegion bufferDamage;
+    // Collected here until commit. The damage in the public state is set from them then.
+    damage_list surface_damage;
+    damage_list buffer_damage;
 
     bool destinationSizeIsSet = false;
 
-    std::deque<wl_resource*> callbacks;
+    std::vector<wl_resource*> callbacks;
 
     QSize destinationSize;
 
-    std::unique_ptr<Feedbacks> feedbacks{std::make_unique<Feedbacks>()};
+    // Created with the first presentation feedback request of a commit.
+    std::unique_ptr<Feedbacks> feedbacks;
 };
 
 class Surface::Private : public Wayland::Resource<Surface>
@@ -73,6 +79,7 @@ public:
 
     void addChild(Subsurface* child);
     void removeChild(Subsurface* child);
+    void detach_children();
 
     bool raiseChild(Subsurface* subsurface, Surface* sibling);
     bool lowerChild(Subsurface* subsurface, Surface* sibling);
@@ -84,20 +91,45 @@ public:
 
     void setSourceRectangle(QRectF const& source);
     void setDestinationSize(QSize const& dest);
-    void addPresentationFeedback(PresentationFeedback* feedback) const;
+    void addPresentationFeedback(PresentationFeedback* feedback);
 
     void installPointerConstraint(LockedPointerV1* lock);
     void installPointerConstraint(ConfinedPointerV1* confinement);
     void installIdleInhibitor(IdleInhibitor* inhibitor);
+    void update_idle_inhibition();
     void installViewport(Viewport* vp);
 
     void commit();
 
+    // Returns true when callbacks were sent. They are held back for clients not reading events.
+    bool frame_rendered(uint32_t msec);
+    void send_frame_done(uint32_t msec);
+
     void updateCurrentState(bool forceChildren);
     void updateCurrentState(SurfaceState& source, bool forceChildren);
 
+    // Moves the changes of @arg source onto @arg target. Used for the cached state of synchronized
+    // subsurfaces, which accumulates commits until the parent commits.
+    void merge_state(SurfaceState& target, SurfaceState& source) const;
+    // Readies the state for the next commit. Values not flagged as changed are left as they are and
+    // containers keep their capacity, so committing does not allocate.
+    static void reset_state(SurfaceState& state);
+
     bool has_role() const;
 
+    // Marks the tree index of this surface and of all its parents as outdated. Stacking changes
+    // are announced as children changes.
+    void invalidate_trees(surface_changes changes);
+    surface_tree& get_tree();
+
+    // The client object is gone when the surface is destroyed with its client.
+    Wayland::Display* display;
+    // Position in the compositor's surface list for constant time removal.
+    size_t compositor_index{0};
+
+    // Index of the tree with this surface as root. Created on the first query.
+    std::unique_ptr<surface_tree> tree;
+
     bool had_buffer_attached{false};
 
     XdgShellSurface* shellSurface = nullptr;
@@ -107,7 +139,7 @@ public:
     SurfaceState current;
     SurfaceState pending;
 
-    QRegion trackedDamage;
+    rect_region tracked_damage;
 
     // Workaround for https://bugreports.qt.io/browse/QTBUG-52192:
     // A subsurface needs to be considered mapped even if it doesn't have a buffer attached.
@@ -124,11 +156,19 @@ public:
     ConfinedPointerV1* confinedPointer{nullptr};
     Viewport* viewport{nullptr};
     QHash<WlOutput*, QMetaObject::Connection> outputDestroyedConnections;
+
+    // Server buffers are persistent per wl_buffer. Connect only once to each of them.
+    std::unordered_map<Buffer*, QMetaObject::Connection> buffer_destroy_notifiers;
     QVector<IdleInhibitor*> idleInhibitors;
+    // Whether the surface is counted as inhibiting idle for the seats. That needs an inhibitor
+    // and the surface being on an output.
+    bool idle_inhibiting{false};
 
 private:
     void update_buffer(SurfaceState const& source, bool& resized);
     void copy_to_current(SurfaceState const& source, bool& resized);
+    void update_damage(SurfaceState const& source);
+    buffer_mapping current_mapping() const;
     void synced_child_update();
 
     void damage(QRect const& rect);
@@ -0,0 +1,209 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include "surface_tree.h"
+
+#include "buffer.h"
+#include "subcompositor.h"
+#include "surface_p.h"
+
+#include <cmath>
+
+namespace Wrapland::Server
+{
+
+surface_tree::surface_tree(Surface* root)
+    : m_root{root}
+{
+}
+
+surface_hit surface_tree::surface_at(QPointF const& pos)
+{
+    if (!update_nodes()) {
+        return {};
+    }
+
+    // The pixel the position lies in.
+    auto const pixel
+        = QPoint(static_cast<int>(std::floor(pos.x())), static_cast<int>(std::floor(pos.y())));
+    if (!m_input_bounds.contains(pixel)) {
+        return {};
+    }
+
+    for (auto it = m_nodes.crbegin(); it != m_nodes.crend(); it++) {
+        if (it->input.contains(pixel)) {
+            return {it->surface, pos - it->geometry.topLeft()};
+        }
+    }
+    return {};
+}
+
+std::vector<surface_visibility> surface_tree::visible_regions(QRect const& clip)
+{
+    if (!update_nodes()) {
+        return {};
+    }
+
+    // Moving the tree around inside the clip does not change what is visible.
+    auto const bounded_clip = clip & m_bounds;
+    if (!m_occlusion_changed && bounded_clip == m_visibility_clip) {
+        return m_visibility;
+    }
+
+    m_visibility.clear();
+    m_visibility.resize(m_nodes.size());
+    m_visibility_clip = bounded_clip;
+    m_occlusion_changed = false;
+
+    // From the top, removing opaque regions from what is left to show of the clip.
+    rect_region uncovered(bounded_clip);
+
+    for (auto index = m_nodes.size(); index > 0; index--) {
+        auto const& node = m_nodes.at(index - 1);
+        auto& entry = m_visibility.at(index - 1);
+
+        entry.surface = node.surface;
+        entry.offset = node.geometry.topLeft();
+
+        if (uncovered.empty()) {
+            // Everything below is hidden.
+            continue;
+        }
+
+        auto visible = uncovered;
+        visible.intersect(node.geometry);
+        visible.translate(-entry.offset);
+        entry.region = visible.to_qregion();
+
+        uncovered.subtract(node.opaque);
+    }
+
+    return m_visibility;
+}
+
+void surface_tree::invalidate()
+{
+    m_rebuild = true;
+}
+
+void surface_tree::invalidate_surface(Surface* surface)
+{
+    if (m_rebuild) {
+        return;
+    }
+
+    auto it = m_indices.find(surface);
+    if (it == m_indices.end()) {
+        // Not in the tree, for example because it was not mapped on the last rebuild.
+        m_rebuild = true;
+        return;
+    }
+
+    m_nodes[it->second].dirty = true;
+    m_nodes_changed = true;
+}
+
+bool surface_tree::update_nodes()
+{
+    if (!m_root->isMapped()) {
+        // The root might have been unmapped with one of its parents, which does not reach us.
+        m_rebuild = true;
+        return false;
+    }
+
+    if (m_rebuild) {
+        rebuild();
+        return true;
+    }
+    if (!m_nodes_changed) {
+        return true;
+    }
+
+    m_input_bounds = {};
+    m_bounds = {};
+    for (auto& node : m_nodes) {
+        if (node.dirty) {
+            update(node);
+        }
+        m_input_bounds = m_input_bounds.united(node.input.bounding_rect());
+        m_bounds = m_bounds.united(node.geometry);
+    }
+    m_nodes_changed = false;
+    return true;
+}
+
+void surface_tree::rebuild()
+{
+    m_nodes.clear();
+    m_indices.clear();
+    m_input_bounds = {};
+    m_bounds = {};
+    m_rebuild = false;
+    m_nodes_changed = false;
+    m_occlusion_changed = true;
+
+    // Depth-first in stacking order. A surface is below its children, which are in the vector from
+    // bottom to top. The stack holds the subsurfaces still to visit with their parent's offset.
+    struct entry {
+        Surface* surface;
+        QPoint offset;
+    };
+    std::vector<entry> stack{{m_root, QPoint()}};
+
+    while (!stack.empty()) {
+        auto const current = stack.back();
+        stack.pop_back();
+
+        auto priv = current.surface->d_ptr;
+        m_indices[current.surface] = m_nodes.size();
+
+        node& added = m_nodes.emplace_back();
+        added.surface = current.surface;
+        added.geometry.moveTopLeft(current.offset);
+        update(added);
+        m_input_bounds = m_input_bounds.united(added.input.bounding_rect());
+        m_bounds = m_bounds.united(added.geometry);
+
+        auto const& children = priv->current.pub.children;
+        for (auto it = children.crbegin(); it != children.crend(); it++) {
+            auto child = (*it)->surface();
+            if (child && child->isMapped()) {
+                stack.push_back({child, current.offset + (*it)->position()});
+            }
+        }
+    }
+}
+
+void surface_tree::update(node& node)
+{
+    auto const& state = node.surface->d_ptr->current.pub;
+    auto const geometry = QRect(node.geometry.topLeft(), node.surface->size());
+
+    node.dirty = false;
+    node.input = rect_region(geometry);
+
+    if (!state.input_is_infinite) {
+        auto input = rect_region(state.input);
+        input.translate(geometry.topLeft());
+        node.input.intersect(input);
+    }
+
+    // Without alpha channel the whole buffer is opaque, whatever the client announced.
+    auto opaque = rect_region(geometry);
+    if (!state.buffer || state.buffer->hasAlphaChannel()) {
+        auto announced = rect_region(state.opaque);
+        announced.translate(geometry.topLeft());
+        opaque.intersect(announced);
+    }
+
+    // New buffers are committed all the time but mostly keep the occlusion as it is.
+    if (geometry != node.geometry || opaque != node.opaque) {
+        m_occlusion_changed = true;
+    }
+    node.geometry = geometry;
+    node.opaque = std::move(opaque);
+}
+
+}
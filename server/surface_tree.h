@@ -0,0 +1,78 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include "rect_region.h"
+#include "surface.h"
+
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace Wrapland::Server
+{
+
+/**
+ * Index of a surface and its subsurfaces. The mapped surfaces of the tree are kept in a flat list
+ * in stacking order with their geometries, input and opaque regions in the coordinates of the
+ * root, so picking a surface is a scan from the top without recursion or region copies.
+ *
+ * Commits only mark what changed. Changed surfaces are updated by themselves, changes to the
+ * stacking, positions or mapping flatten the tree again. Both happen on the next query. Visible
+ * regions are cached and only computed again when the clip or an opaque region in the tree
+ * changes.
+ */
+class surface_tree
+{
+public:
+    explicit surface_tree(Surface* root);
+
+    surface_hit surface_at(QPointF const& pos);
+    /// With @arg clip in the coordinates of the root.
+    std::vector<surface_visibility> visible_regions(QRect const& clip);
+
+    /// Stacking, positions or mapping of surfaces in the tree changed.
+    void invalidate();
+    /// The input region, opaque region, buffer or size of @arg surface changed.
+    void invalidate_surface(Surface* surface);
+
+private:
+    struct node {
+        Surface* surface;
+        QRect geometry;
+        rect_region input;
+        rect_region opaque;
+        bool dirty{false};
+    };
+
+    bool update_nodes();
+    void rebuild();
+    void update(node& node);
+
+    Surface* m_root;
+
+    // Bottom to top.
+    std::vector<node> m_nodes;
+    // Position of each surface in the nodes. A surface can be in the trees of all its ancestors,
+    // so every tree keeps its own.
+    std::unordered_map<Surface*, size_t> m_indices;
+    QRect m_input_bounds;
+    QRect m_bounds;
+
+    bool m_rebuild{true};
+    bool m_nodes_changed{false};
+
+    // Last computed visible regions with the clip they were computed for, limited to the bounds.
+    std::vector<surface_visibility> m_visibility;
+    QRect m_visibility_clip;
+    bool m_occlusion_changed{true};
+};
+
+}
@@ -5,15 +5,19 @@
     SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
 */
 #include "touch_pool.h"
+#include "client.h"
 #include "data_device.h"
 #include "display.h"
 #include "pointer.h"
 #include "pointer_p.h"
 #include "seat.h"
 #include "seat_p.h"
+#include "surface.h"
 #include "touch.h"
 #include "utils.h"
 
+#include "wayland/probes.h"
+
 #include <config-wrapland.h>
 
 #if HAVE_LINUX_INPUT_H
@@ -107,6 +111,12 @@ int32_t touch_pool::touch_down(QPointF const& globalPosition)
     int32_t const id = ids.empty() ? 0 : ids.crbegin()->first + 1;
     auto const serial = seat->d_ptr->display()->handle->nextSerial();
     auto const pos = globalPosition - focus.offset;
+    WRAPLAND_PROBE(touch_down,
+                   Wayland::probe_pid(focus.surface),
+                   Wayland::probe_id(focus.surface),
+                   id,
+                   static_cast<int32_t>(pos.x()),
+                   static_cast<int32_t>(pos.y()));
     for (auto touch : focus.devices) {
         touch->down(id, serial, pos);
     }
@@ -141,6 +151,8 @@ void touch_pool::touch_up(int32_t id)
         // the implicitly grabbing touch point has been upped
         seat->drags().drop();
     }
+    WRAPLAND_PROBE(
+        touch_up, Wayland::probe_pid(focus.surface), Wayland::probe_id(focus.surface), id);
     for (auto touch : focus.devices) {
         touch->up(id, serial);
     }
@@ -162,6 +174,12 @@ void touch_pool::touch_move(int32_t id, QPointF const& globalPosition)
 {
     Q_ASSERT(ids.count(id));
     auto const pos = globalPosition - focus.offset;
+    WRAPLAND_PROBE(touch_move,
+                   Wayland::probe_pid(focus.surface),
+                   Wayland::probe_id(focus.surface),
+                   id,
+                   static_cast<int32_t>(pos.x()),
+                   static_cast<int32_t>(pos.y()));
     for (auto touch : focus.devices) {
         touch->move(id, pos);
     }
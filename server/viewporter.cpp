@@ -110,6 +110,16 @@ Viewport::Viewport(Client* client, uint32_t version, uint32_t id, Surface* surfa
     connect(surface, &Surface::resourceDestroyed, this, [this] { d_ptr->surface = nullptr; });
 }
 
+void* Viewport::operator new(std::size_t size)
+{
+    return Wayland::object_pool<Viewport>::allocate(size);
+}
+
+void Viewport::operator delete(void* ptr, std::size_t size)
+{
+    Wayland::object_pool<Viewport>::deallocate(ptr, size);
+}
+
 void Viewport::Private::setSourceCallback([[maybe_unused]] wl_client* wlClient,
                                           wl_resource* wlResource,
                                           wl_fixed_t pos_x,
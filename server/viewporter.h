@@ -57,6 +57,11 @@ public:
                       uint32_t id,
                       Surface* surface,
                       QObject* parent = nullptr);
+
+    // Objects are created per request and come from a pool.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
     friend class Viewporter;
 
     class Private;
@@ -24,6 +24,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "wayland/client.h"
 #include "wayland/display.h"
 #include "wayland/global.h"
+#include "wayland/object_pool.h"
 #include "wayland/resource.h"
 
 #include <wayland-viewporter-server-protocol.h>
@@ -51,7 +52,9 @@ private:
     static const struct wp_viewporter_interface s_interface;
 };
 
-class Viewport::Private : public Wayland::Resource<Viewport>
+class Viewport::Private
+    : public Wayland::Resource<Viewport>
+    , public Wayland::pooled<Viewport::Private>
 {
 public:
     Private(Client* client, uint32_t version, uint32_t id, Surface* _surface, Viewport* q_ptr);
@@ -25,6 +25,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "send.h"
 
 #include <cassert>
+#include <cstddef>
 #include <tuple>
 #include <wayland-server.h>
 
@@ -127,6 +128,9 @@ public:
     uint32_t version;
     wl_resource* resource;
 
+    // Position in the binds of the global nucleus for removal in constant time.
+    size_t nucleus_index{0};
+
 private:
     static Bind<Global, Nucleus>* self(wl_resource* resource)
     {
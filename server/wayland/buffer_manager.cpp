@@ -20,9 +20,9 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <QObject>
 
 #include "../buffer.h"
+#include "../display.h"
 #include "buffer_manager.h"
 
-#include <algorithm>
 #include <cassert>
 
 namespace Wrapland::Server::Wayland
@@ -30,25 +30,62 @@ namespace Wrapland::Server::Wayland
 
 std::optional<std::shared_ptr<Buffer>> BufferManager::fromResource(wl_resource* resource) const
 {
-    for (auto const& [key, val] : m_buffers) {
-        auto locked = val.lock();
-        if (locked->resource() == resource) {
-            return std::optional<std::shared_ptr<Buffer>>{locked};
-        }
+    auto it = m_buffers.find(resource);
+    if (it == m_buffers.end()) {
+        return std::nullopt;
     }
-    return std::nullopt;
+    return std::optional<std::shared_ptr<Buffer>>{it->second};
 }
 
-void BufferManager::addBuffer(std::weak_ptr<Buffer> const& buffer)
+void BufferManager::addBuffer(std::shared_ptr<Buffer> const& buffer)
 {
-    m_buffers.emplace(buffer.lock().get(), buffer);
+    assert(buffer->resource());
+    [[maybe_unused]] auto const [it, inserted] = m_buffers.emplace(buffer->resource(), buffer);
+    assert(inserted);
 }
 
-void BufferManager::removeBuffer(Buffer* buffer)
+std::shared_ptr<Buffer> BufferManager::removeBuffer(wl_resource* resource)
 {
-    auto it = m_buffers.find(buffer);
-    assert(it != m_buffers.end());
+    auto it = m_buffers.find(resource);
+    if (it == m_buffers.end()) {
+        return nullptr;
+    }
+
+    auto buffer = std::move(it->second);
     m_buffers.erase(it);
+    return buffer;
+}
+
+void BufferManager::release(wl_resource* resource, bool immediate)
+{
+    wl_buffer_send_release(resource);
+    m_release_stats.sent++;
+
+    auto client = wl_resource_get_client(resource);
+
+    if (immediate) {
+        wl_client_flush(client);
+        m_release_stats.immediate++;
+        return;
+    }
+
+    m_release_clients.insert(client);
+    m_queued_releases++;
+}
+
+void BufferManager::flush_releases()
+{
+    // The display flushes every client once. Without queuing each release would have been flushed
+    // on its own.
+    m_release_stats.flushes_saved += m_queued_releases - m_release_clients.size();
+
+    m_release_clients.clear();
+    m_queued_releases = 0;
+}
+
+buffer_release_stats BufferManager::release_stats() const
+{
+    return {m_release_stats.sent, m_release_stats.immediate, m_release_stats.flushes_saved};
 }
 
 bool BufferManager::beginShmAccess(wl_shm_buffer* buffer)
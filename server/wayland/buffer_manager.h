@@ -23,16 +23,20 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
+struct wl_client;
 struct wl_resource;
 struct wl_shm_buffer;
 
 namespace Wrapland::Server
 {
 class Buffer;
+struct buffer_release_stats;
 
 namespace Wayland
 {
@@ -43,17 +47,38 @@ class BufferManager
 public:
     std::optional<std::shared_ptr<Buffer>> fromResource(wl_resource* resource) const;
 
-    void addBuffer(std::weak_ptr<Wrapland::Server::Buffer> const& buffer);
-    void removeBuffer(Buffer* buffer);
+    void addBuffer(std::shared_ptr<Wrapland::Server::Buffer> const& buffer);
+    std::shared_ptr<Buffer> removeBuffer(wl_resource* resource);
 
     bool beginShmAccess(wl_shm_buffer* buffer);
     void endShmAccess();
 
+    /**
+     * Sends the release event for @arg resource. Unless @arg immediate is set the event is only
+     * queued and goes out with the next flush of the display.
+     */
+    void release(wl_resource* resource, bool immediate);
+    void flush_releases();
+
+    buffer_release_stats release_stats() const;
+
 private:
     wl_shm_buffer* m_accessedShmBuffer{nullptr};
     int m_accessCounter{0};
 
-    std::unordered_map<Buffer*, std::weak_ptr<Buffer>> m_buffers;
+    // One buffer per wl_buffer resource, owned here for as long as the resource exists. Entries are
+    // dropped as soon as their resource is destroyed, so a recycled resource address never
+    // resolves to a stale buffer.
+    std::unordered_map<wl_resource*, std::shared_ptr<Buffer>> m_buffers;
+
+    std::unordered_set<wl_client*> m_release_clients;
+    uint64_t m_queued_releases{0};
+
+    struct {
+        uint64_t sent{0};
+        uint64_t immediate{0};
+        uint64_t flushes_saved{0};
+    } m_release_stats;
 };
 
 }
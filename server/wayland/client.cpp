@@ -38,12 +38,6 @@ Client::Client(wl_client* native, Server::Client* handle)
     m_destroyWrapper.listener.notify = destroyListenerCallback;
     wl_client_add_destroy_listener(native, &m_destroyWrapper.listener);
     wl_client_get_credentials(native, &m_pid, &m_user, &m_group);
-
-    m_executablePath
-        // Qt types have limited compatibility with modern C++. Remove this clang-tidy exception
-        // once it is ported to std::string.
-        // NOLINTNEXTLINE(performance-no-automatic-move)
-        = QFileInfo(QStringLiteral("/proc/%1/exe").arg(m_pid)).symLinkTarget().toUtf8().constData();
 }
 
 Client::~Client()
@@ -130,7 +124,19 @@ uid_t Client::userId() const
 
 std::string Client::executablePath() const
 {
-    return m_executablePath;
+    // Resolving the link goes to the filesystem. Most clients are never asked for their path, so
+    // only do it on demand.
+    if (!m_executablePath) {
+        m_executablePath
+            // Qt types have limited compatibility with modern C++. Remove this clang-tidy exception
+            // once it is ported to std::string.
+            // NOLINTNEXTLINE(performance-no-automatic-move)
+            = QFileInfo(QStringLiteral("/proc/%1/exe").arg(m_pid))
+                  .symLinkTarget()
+                  .toUtf8()
+                  .constData();
+    }
+    return *m_executablePath;
 }
 
 std::string Client::security_context_app_id() const
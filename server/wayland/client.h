@@ -19,6 +19,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #pragma once
 
+#include <optional>
 #include <string>
 #include <sys/types.h>
 #include <vector>
@@ -76,7 +77,7 @@ private:
     pid_t m_pid = 0;
     uid_t m_user = 0;
     gid_t m_group = 0;
-    std::string m_executablePath;
+    mutable std::optional<std::string> m_executablePath;
     std::string m_security_context_app_id;
 
     struct DestroyWrapper {
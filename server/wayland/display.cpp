@@ -22,7 +22,6 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <QAbstractEventDispatcher>
 #include <QSocketNotifier>
 #include <QThread>
-#include <QTimer>
 
 #include "logging.h"
 
@@ -31,6 +30,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "buffer_manager.h"
 #include "client.h"
 #include "nucleus.h"
+#include "probes.h"
 
 #include "utils.h"
 
@@ -38,12 +38,67 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "../display.h"
 
 #include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <exception>
+#include <poll.h>
 #include <wayland-server.h>
 
 namespace Wrapland::Server::Wayland
 {
 
+namespace
+{
+
+size_t padded(size_t size)
+{
+    return (size + 3) & ~size_t{3};
+}
+
+// Size of the message on the wire. File descriptors are passed out of band and not counted.
+size_t wire_size(wl_protocol_logger_message const* message)
+{
+    size_t size{8};
+    int arg{0};
+
+    for (auto sig = message->message->signature; *sig; sig++) {
+        switch (*sig) {
+        case 'i':
+        case 'u':
+        case 'f':
+        case 'o':
+        case 'n':
+            size += 4;
+            arg++;
+            break;
+        case 's': {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            auto str = message->arguments[arg].s;
+            size += 4 + (str ? padded(strlen(str) + 1) : 0);
+            arg++;
+            break;
+        }
+        case 'a': {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            auto array = message->arguments[arg].a;
+            size += 4 + (array ? padded(array->size) : 0);
+            arg++;
+            break;
+        }
+        case 'h':
+            arg++;
+            break;
+        default:
+            // Version number and nullable markers.
+            break;
+        }
+    }
+
+    return size;
+}
+
+}
+
 Display* Display::backendCast(Server::Display* display)
 {
     return display->d_ptr.get();
@@ -57,7 +112,7 @@ Display::Display(Server::Display* handle)
 
 Display::~Display()
 {
-    for (auto stale_global : m_stale_globals) {
+    for (auto& [stale_global, timer] : m_stale_globals) {
         delete stale_global;
     }
 
@@ -91,18 +146,21 @@ void Display::addGlobal(BasicNucleus* nucleus)
 void Display::removeGlobal(BasicNucleus* nucleus)
 {
     m_globals.erase(std::remove(m_globals.begin(), m_globals.end(), nucleus), m_globals.end());
-    m_stale_globals.push_back(nucleus);
 
-    // A single-shot QTimer is cleaned up by Qt internally when the receiver (here handle) goes
-    // away what clang-tidy does not understand.
-    // NOLINTNEXTLINE(clang-analyzer-cplusplus.NewDeleteLeaks)
-    QTimer::singleShot(s_global_stale_time, handle, [this, nucleus] {
+    auto [it, inserted] = m_stale_globals.try_emplace(nucleus, m_timer_wheel);
+    Q_ASSERT(inserted);
+
+    it->second.start(s_global_stale_time, [this, nucleus] {
         delete nucleus;
-        m_stale_globals.erase(std::remove(m_stale_globals.begin(), m_stale_globals.end(), nucleus),
-                              m_stale_globals.end());
+        m_stale_globals.erase(nucleus);
     });
 }
 
+TimerWheel& Display::timer_wheel()
+{
+    return m_timer_wheel;
+}
+
 void Display::addSocket()
 {
     if (!socket_name.empty()) {
@@ -118,12 +176,14 @@ void Display::addSocket()
     }
 }
 
-void Display::start()
+bool Display::setup_loop()
 {
     Q_ASSERT(!m_running);
 
     if (!m_display) {
         m_display = wl_display_create();
+        setup_flush_tracking();
+        apply_client_buffer_limit();
     }
 
     try {
@@ -131,11 +191,25 @@ void Display::start()
     } catch (std::bad_exception&) {
         qCWarning(WRAPLAND_SERVER, "Failed to create Wayland socket");
         // TODO(romangg): Shall we rethrow?
-        return;
+        return false;
     }
 
     m_loop = wl_display_get_event_loop(m_display);
-    installSocketNotifier(handle);
+    return true;
+}
+
+void Display::start()
+{
+    if (setup_loop()) {
+        installSocketNotifier(handle);
+    }
+}
+
+void Display::start_external_loop()
+{
+    if (setup_loop()) {
+        setRunning(true);
+    }
 }
 
 void Display::startLoop()
@@ -193,12 +267,384 @@ void Display::installSocketNotifier(QObject* parent)
     setRunning(true);
 }
 
+void Display::setup_flush_tracking()
+{
+    m_client_created.display = this;
+    m_client_created.listener.notify = client_created_callback;
+    wl_display_add_client_created_listener(m_display, &m_client_created.listener);
+
+    // The logger sees every event queued for a client, including the ones libwayland sends on its
+    // own like delete_id or callback done.
+    wl_display_add_protocol_logger(m_display, protocol_logger_callback, this);
+}
+
+void Display::client_created_callback(wl_listener* listener, void* data)
+{
+    // NOLINTNEXTLINE
+    ClientCreatedWrapper* wrapper = wl_container_of(listener, wrapper, listener);
+    auto display = wrapper->display;
+    auto wlClient = static_cast<wl_client*>(data);
+
+    if (display->m_torn_down_client == wlClient) {
+        display->m_torn_down_client = nullptr;
+    }
+
+    auto& watch = display->m_client_watches[wlClient];
+    watch.display = display;
+    watch.client = wlClient;
+    watch.destroy_listener.notify = client_destroyed_callback;
+    wl_client_add_destroy_listener(wlClient, &watch.destroy_listener);
+}
+
+void Display::client_destroyed_callback(wl_listener* listener, void* data)
+{
+    // NOLINTNEXTLINE
+    ClientWatch* watch = wl_container_of(listener, watch, destroy_listener);
+    auto display = watch->display;
+    auto wlClient = static_cast<wl_client*>(data);
+
+    // This listener was added first and runs before libwayland destroys the client's resources.
+    display->m_torn_down_client = wlClient;
+
+    if (watch->dirty) {
+        remove_one(display->m_dirty_clients, wlClient);
+    }
+    if (watch->writable) {
+        wl_event_source_remove(watch->writable);
+    }
+    if (display->m_timed_request.client == wlClient) {
+        display->m_timed_request = {};
+    }
+
+    // The listener is already unlinked by libwayland, so the watch can go with it.
+    display->m_client_watches.erase(wlClient);
+}
+
+void Display::protocol_logger_callback(void* data,
+                                       wl_protocol_logger_type type,
+                                       wl_protocol_logger_message const* message)
+{
+    auto display = static_cast<Display*>(data);
+    auto const is_request = type == WL_PROTOCOL_LOGGER_REQUEST;
+    auto const tracing = display->m_trace.capacity() > 0;
+
+    if (is_request) {
+        display->m_dispatched_requests++;
+        if (!display->m_protocol_stats && !tracing) {
+            return;
+        }
+    }
+
+    auto wlClient = wl_resource_get_client(message->resource);
+
+    if (tracing) {
+        trace_record record;
+        record.start = Trace::now();
+        record.interface = wl_resource_get_class(message->resource);
+        record.message = message->message->name;
+        record.id = wl_resource_get_id(message->resource);
+        record.kind = is_request ? trace_kind::request : trace_kind::event;
+        wl_client_get_credentials(wlClient, &record.pid, nullptr, nullptr);
+        display->m_trace.record(record);
+    }
+
+    // Events might still be sent from resource destructors of a client that is being destroyed.
+    auto it = display->m_client_watches.find(wlClient);
+    if (it == display->m_client_watches.end()) {
+        return;
+    }
+
+    auto& watch = it->second;
+
+    if (!is_request) {
+        watch.queued_bytes += wire_size(message);
+        if (!watch.dirty) {
+            watch.dirty = true;
+            display->m_dirty_clients.push_back(wlClient);
+        }
+    }
+
+    if (display->m_protocol_stats) {
+        display->count_message(wlClient, watch, is_request, message);
+    }
+}
+
+void Display::count_message(wl_client* wlClient,
+                            ClientWatch& watch,
+                            bool is_request,
+                            wl_protocol_logger_message const* message)
+{
+    auto& stats = watch.stats[message->message];
+    if (!stats.interface) {
+        stats.interface = wl_resource_get_class(message->resource);
+        stats.opcode = static_cast<uint32_t>(message->message_opcode);
+        stats.is_request = is_request;
+    }
+
+    stats.count++;
+    stats.bytes += wire_size(message);
+
+    if (is_request) {
+        end_request_timing();
+        m_timed_request.stats = &stats;
+        m_timed_request.client = wlClient;
+        m_timed_request.start = std::chrono::steady_clock::now();
+    }
+}
+
+void Display::end_request_timing()
+{
+    if (!m_timed_request.stats) {
+        return;
+    }
+
+    m_timed_request.stats->dispatch_time
+        += std::chrono::steady_clock::now() - m_timed_request.start;
+    m_timed_request = {};
+}
+
 void Display::flush()
 {
     if (!m_display || !m_loop) {
         return;
     }
-    wl_display_flush_clients(m_display);
+    m_bufferManager->flush_releases();
+
+    trace_record record;
+    record.start = Trace::now();
+    record.id = static_cast<uint32_t>(m_dirty_clients.size());
+    record.kind = trace_kind::flush;
+
+    WRAPLAND_PROBE(flush, m_dirty_clients.size(), m_client_watches.size());
+
+    m_flush_stats.flushes++;
+    m_flush_stats.clients_skipped += m_client_watches.size() - m_dirty_clients.size();
+    m_flush_stats.clients_flushed += m_dirty_clients.size();
+
+    std::swap(m_dirty_clients, m_flushing_clients);
+
+    for (auto wlClient : m_flushing_clients) {
+        auto& watch = m_client_watches.at(wlClient);
+        watch.dirty = false;
+
+        // A congested client gets its events once its socket is writable.
+        if (!watch.congested) {
+            flush_client(wlClient, watch);
+        }
+    }
+    m_flushing_clients.clear();
+
+    if (m_broken_clients) {
+        // Only a flush of all clients makes libwayland destroy a client with a broken connection.
+        m_broken_clients = false;
+        m_flush_stats.full_flushes++;
+        wl_display_flush_clients(m_display);
+    }
+
+    if (record.id > 0) {
+        record.duration = Trace::now() - record.start;
+        m_trace.record(record);
+    }
+}
+
+void Display::flush(wl_client* wlClient)
+{
+    auto it = m_client_watches.find(wlClient);
+    if (it == m_client_watches.end() || it->second.congested) {
+        return;
+    }
+
+    auto& watch = it->second;
+    if (watch.dirty) {
+        watch.dirty = false;
+        remove_one(m_dirty_clients, wlClient);
+    }
+
+    m_flush_stats.clients_flushed++;
+    flush_client(wlClient, watch);
+}
+
+bool Display::flush_client(wl_client* wlClient, ClientWatch& watch)
+{
+    // wl_client_flush does not report errors but leaves errno from the failed send behind.
+    errno = 0;
+    wl_client_flush(wlClient);
+    if (errno == 0) {
+        watch.queued_bytes = 0;
+        return true;
+    }
+
+    if (errno == EAGAIN) {
+        set_congested(wlClient, watch);
+    } else {
+        // Waiting does not help a dead peer. It is destroyed on the next flush.
+        m_broken_clients = true;
+    }
+    return false;
+}
+
+void Display::set_congested(wl_client* wlClient, ClientWatch& watch)
+{
+    if (watch.congested) {
+        return;
+    }
+
+    // The fd is duplicated by the event loop and watched alongside the one of libwayland.
+    watch.writable = wl_event_loop_add_fd(
+        m_loop, wl_client_get_fd(wlClient), WL_EVENT_WRITABLE, client_writable_callback, &watch);
+    if (!watch.writable) {
+        qCWarning(WRAPLAND_SERVER, "Could not watch a congested client for its socket to drain");
+        return;
+    }
+
+    watch.congested = true;
+    m_flush_stats.congestions++;
+}
+
+int Display::client_writable_callback(int /*fd*/, uint32_t /*mask*/, void* data)
+{
+    auto watch = static_cast<ClientWatch*>(data);
+    watch->display->drain_congested_client(*watch);
+    return 0;
+}
+
+void Display::drain_congested_client(ClientWatch& watch)
+{
+    wl_event_source_remove(watch.writable);
+    watch.writable = nullptr;
+    watch.congested = false;
+
+    if (!flush_client(watch.client, watch)) {
+        // Congested again with the socket still full, or broken and destroyed on the next flush.
+        return;
+    }
+
+    // The client reads again. It gets the latest state of everything held back.
+    auto deferred = std::move(watch.deferred);
+    watch.deferred.clear();
+    for (auto& [key, send] : deferred) {
+        send();
+    }
+}
+
+void Display::set_client_buffer_limit(size_t bytes)
+{
+    m_client_buffer_limit = bytes;
+    apply_client_buffer_limit();
+}
+
+size_t Display::client_buffer_limit() const
+{
+    return m_client_buffer_limit;
+}
+
+void Display::set_damage_rect_limit(size_t count)
+{
+    m_damage_rect_limit = count;
+}
+
+size_t Display::damage_rect_limit() const
+{
+    return m_damage_rect_limit;
+}
+
+void Display::apply_client_buffer_limit()
+{
+#if WAYLAND_VERSION_MAJOR > 1 || WAYLAND_VERSION_MINOR >= 23
+    if (!m_display) {
+        return;
+    }
+
+    auto const limit
+        = m_client_buffer_limit > 0 ? m_client_buffer_limit : s_default_client_buffer_limit;
+    wl_display_set_default_max_buffer_size(m_display, limit);
+    for (auto& [wlClient, watch] : m_client_watches) {
+        wl_client_set_max_buffer_size(wlClient, limit);
+    }
+#endif
+}
+
+bool Display::coalescing(wl_client* wlClient)
+{
+    auto it = m_client_watches.find(wlClient);
+    if (it == m_client_watches.end()) {
+        return false;
+    }
+
+    auto& watch = it->second;
+    if (watch.congested) {
+        return true;
+    }
+
+    auto const limit
+        = m_client_buffer_limit > 0 ? m_client_buffer_limit : s_default_client_buffer_limit;
+    if (watch.queued_bytes < limit / 2) {
+        return false;
+    }
+
+    // The queued bytes are an upper bound. Whether the client is slow only the socket can tell.
+    return !flush_client(wlClient, watch);
+}
+
+void Display::defer_event(wl_client* wlClient, void const* key, std::function<void()> send)
+{
+    auto it = m_client_watches.find(wlClient);
+    if (it == m_client_watches.end()) {
+        send();
+        return;
+    }
+
+    auto& deferred = it->second.deferred;
+    m_flush_stats.events_deferred++;
+
+    auto entry = std::find_if(
+        deferred.begin(), deferred.end(), [key](auto const& entry) { return entry.first == key; });
+    if (entry != deferred.end()) {
+        entry->second = std::move(send);
+        m_flush_stats.events_replaced++;
+        return;
+    }
+
+    deferred.emplace_back(key, std::move(send));
+}
+
+bool Display::has_deferred_event(wl_client* wlClient, void const* key) const
+{
+    auto it = m_client_watches.find(wlClient);
+    if (it == m_client_watches.end()) {
+        return false;
+    }
+
+    auto const& deferred = it->second.deferred;
+    return std::any_of(
+        deferred.cbegin(), deferred.cend(), [key](auto const& entry) { return entry.first == key; });
+}
+
+void Display::send_deferred_event(wl_client* wlClient, void const* key)
+{
+    auto it = m_client_watches.find(wlClient);
+    if (it == m_client_watches.end()) {
+        return;
+    }
+
+    auto& deferred = it->second.deferred;
+    auto entry = std::find_if(
+        deferred.begin(), deferred.end(), [key](auto const& entry) { return entry.first == key; });
+    if (entry == deferred.end()) {
+        return;
+    }
+
+    // Removed before sending, the event might lead to further events being deferred.
+    auto send = std::move(entry->second);
+    deferred.erase(entry);
+    send();
+}
+
+void Display::drop_deferred_event(wl_client* wlClient, void const* key)
+{
+    if (auto it = m_client_watches.find(wlClient); it != m_client_watches.end()) {
+        remove_all_if(it->second.deferred, [key](auto const& entry) { return entry.first == key; });
+    }
 }
 
 void Display::dispatchEvents(int msecTimeout)
@@ -209,7 +655,8 @@ void Display::dispatchEvents(int msecTimeout)
         dispatch();
     } else if (m_loop) {
         wl_event_loop_dispatch(m_loop, msecTimeout);
-        wl_display_flush_clients(m_display);
+        end_request_timing();
+        flush();
     }
 }
 
@@ -218,36 +665,80 @@ void Display::dispatch()
     if (!m_display || !m_loop) {
         return;
     }
+
+    [[maybe_unused]] auto const requests = m_dispatched_requests;
+    WRAPLAND_PROBE(dispatch_begin, requests);
+
     if (wl_event_loop_dispatch(m_loop, 0) != 0) {
         qCWarning(WRAPLAND_SERVER, "Error on dispatching Wayland event loop");
     }
+    end_request_timing();
+
+    WRAPLAND_PROBE(dispatch_end, m_dispatched_requests - requests);
 }
 
-Client* Display::getClient(wl_client* wlClient)
+bool Display::dispatch(dispatch_budget const& budget)
 {
-    Q_ASSERT(wlClient);
+    if (!m_display || !m_loop) {
+        return false;
+    }
 
-    auto it = std::find_if(m_clients.cbegin(), m_clients.cend(), [wlClient](Client* client) {
-        return client->native == wlClient;
-    });
+    auto const start = std::chrono::steady_clock::now();
+    auto const requests_limit = m_dispatched_requests + budget.requests;
+
+    // Budgets are checked between dispatch rounds. Each round handles up to a fixed number of
+    // ready sources, with all requests a client has buffered.
+    while (true) {
+        dispatch();
 
-    if (it != m_clients.cend()) {
-        return *it;
+        if (!has_pending_events()) {
+            return false;
+        }
+        if (budget.requests > 0 && m_dispatched_requests >= requests_limit) {
+            return true;
+        }
+        if (budget.time.count() > 0 && std::chrono::steady_clock::now() - start >= budget.time) {
+            return true;
+        }
     }
+}
 
-    return nullptr;
+bool Display::has_pending_events() const
+{
+    pollfd pfd{wl_event_loop_get_fd(m_loop), POLLIN, 0};
+    return poll(&pfd, 1, 0) > 0;
+}
+
+int Display::event_loop_fd() const
+{
+    return m_loop ? wl_event_loop_get_fd(m_loop) : -1;
+}
+
+Client* Display::getClient(wl_client* wlClient)
+{
+    Q_ASSERT(wlClient);
+
+    auto it = m_client_index.find(wlClient);
+    return it == m_client_index.end() ? nullptr : it->second;
 }
 
 Server::Client* Display::createClientHandle(wl_client* wlClient)
 {
     auto priv_cl = Client::create_client(wlClient, this);
     m_clients.push_back(priv_cl);
+    m_client_index.emplace(wlClient, priv_cl);
 
-    QObject::connect(priv_cl->handle, &Server::Client::disconnected, handle, [this](auto client) {
-        remove_all_if(m_clients,
-                      [client](auto&& candidate) { return candidate->handle == client; });
-        Q_EMIT handle->clientDisconnected(client);
-    });
+    WRAPLAND_PROBE(client_connect, priv_cl->processId());
+
+    QObject::connect(priv_cl->handle,
+                     &Server::Client::disconnected,
+                     handle,
+                     [this, wlClient, priv_cl](auto client) {
+                         WRAPLAND_PROBE(client_disconnect, priv_cl->processId());
+                         m_client_index.erase(wlClient);
+                         remove_one(m_clients, priv_cl);
+                         Q_EMIT handle->clientDisconnected(client);
+                     });
 
     return priv_cl->handle;
 }
@@ -257,9 +748,90 @@ std::vector<Client*> const& Display::clients() const
     return m_clients;
 }
 
+bool Display::tearing_down(wl_client* wlClient) const
+{
+    return m_torn_down_client == wlClient;
+}
+
 BufferManager* Display::bufferManager() const
 {
     return m_bufferManager.get();
 }
 
+void Display::set_protocol_stats_enabled(bool enable)
+{
+    if (!enable) {
+        end_request_timing();
+    }
+    m_protocol_stats = enable;
+}
+
+bool Display::protocol_stats_enabled() const
+{
+    return m_protocol_stats;
+}
+
+std::vector<protocol_stats_entry> Display::protocol_stats(wl_client* wlClient) const
+{
+    std::vector<protocol_stats_entry> entries;
+
+    auto it = m_client_watches.find(wlClient);
+    if (it == m_client_watches.end()) {
+        return entries;
+    }
+
+    for (auto const& [message, stats] : it->second.stats) {
+        protocol_stats_entry entry;
+        entry.interface = stats.interface;
+        entry.message = message->name;
+        entry.opcode = stats.opcode;
+        entry.is_request = stats.is_request;
+        entry.count = stats.count;
+        entry.bytes = stats.bytes;
+        entry.dispatch_time = stats.dispatch_time;
+        entries.push_back(std::move(entry));
+    }
+
+    return entries;
+}
+
+void Display::reset_protocol_stats(wl_client* wlClient)
+{
+    if (m_timed_request.client == wlClient) {
+        m_timed_request = {};
+    }
+    if (auto it = m_client_watches.find(wlClient); it != m_client_watches.end()) {
+        it->second.stats.clear();
+    }
+}
+
+void Display::reset_protocol_stats()
+{
+    m_timed_request = {};
+    for (auto& [wlClient, watch] : m_client_watches) {
+        watch.stats.clear();
+    }
+}
+
+Trace& Display::trace()
+{
+    return m_trace;
+}
+
+Trace const& Display::trace() const
+{
+    return m_trace;
+}
+
+client_flush_stats Display::flush_stats() const
+{
+    return {m_flush_stats.flushes,
+            m_flush_stats.clients_flushed,
+            m_flush_stats.clients_skipped,
+            m_flush_stats.full_flushes,
+            m_flush_stats.congestions,
+            m_flush_stats.events_deferred,
+            m_flush_stats.events_replaced};
+}
+
 }
@@ -19,16 +19,23 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #pragma once
 
+#include "timer_wheel.h"
+#include "trace.h"
+
 #include <EGL/egl.h>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
+#include <wayland-server.h>
 
 struct wl_client;
 struct wl_display;
 struct wl_event_loop;
+struct wl_event_source;
 struct wl_global;
 
 class QObject;
@@ -37,6 +44,9 @@ namespace Wrapland::Server
 {
 class Client;
 class Display;
+struct client_flush_stats;
+struct dispatch_budget;
+struct protocol_stats_entry;
 
 namespace Wayland
 {
@@ -56,14 +66,19 @@ public:
     wl_display* native() const;
 
     void start();
+    void start_external_loop();
     void terminate();
 
     void startLoop();
 
     void flush();
+    /// Flushes a single client right away. Clients not reading their events are left to flush().
+    void flush(wl_client* wlClient);
 
     void dispatchEvents(int msecTimeout = -1);
     void dispatch();
+    bool dispatch(dispatch_budget const& budget);
+    int event_loop_fd() const;
 
     bool running() const;
     void setRunning(bool running);
@@ -75,28 +90,181 @@ public:
 
     std::vector<Client*> const& clients() const;
 
+    /**
+     * Whether the client is being destroyed. Its resources are then destroyed one after the other
+     * and can skip updates that only matter to objects of the same client. The client object is
+     * already gone at that point.
+     */
+    bool tearing_down(wl_client* wlClient) const;
+
     static Display* backendCast(Server::Display* display);
 
     BufferManager* bufferManager() const;
 
+    /// Shared by all timeouts of the server.
+    TimerWheel& timer_wheel();
+
+    client_flush_stats flush_stats() const;
+
+    void set_client_buffer_limit(size_t bytes);
+    size_t client_buffer_limit() const;
+
+    void set_damage_rect_limit(size_t count);
+    size_t damage_rect_limit() const;
+
+    /**
+     * Whether events for the client are coalesced because it does not read them fast enough. A
+     * client is considered slow once its socket was full on a flush or the events queued since
+     * its last complete flush reach half the buffer limit without the socket draining.
+     */
+    bool coalescing(wl_client* wlClient);
+
+    /**
+     * Holds back an event until the client has drained its buffer. Events with the same key
+     * replace the one held back before, so only the latest state is sent. Senders of other events
+     * for the same object send held back events first to keep the order.
+     */
+    void defer_event(wl_client* wlClient, void const* key, std::function<void()> send);
+    bool has_deferred_event(wl_client* wlClient, void const* key) const;
+    /// Sends the event held back for @arg key now, without the ones of other objects.
+    void send_deferred_event(wl_client* wlClient, void const* key);
+    void drop_deferred_event(wl_client* wlClient, void const* key);
+
+    Trace& trace();
+    Trace const& trace() const;
+
+    void set_protocol_stats_enabled(bool enable);
+    bool protocol_stats_enabled() const;
+    std::vector<protocol_stats_entry> protocol_stats(wl_client* wlClient) const;
+    void reset_protocol_stats(wl_client* wlClient);
+    void reset_protocol_stats();
+
     std::string socket_name;
     Server::Display* handle;
     EGLDisplay eglDisplay{EGL_NO_DISPLAY};
 
+    // Surfaces holding off idle for all seats.
+    size_t idle_inhibiting_surfaces{0};
+
 private:
+    bool setup_loop();
     void addSocket();
+    void setup_flush_tracking();
+    void apply_client_buffer_limit();
+    bool has_pending_events() const;
+
+    static void client_created_callback(wl_listener* listener, void* data);
+    static void client_destroyed_callback(wl_listener* listener, void* data);
+    static int client_writable_callback(int fd, uint32_t mask, void* data);
+    static void protocol_logger_callback(void* data,
+                                         wl_protocol_logger_type type,
+                                         wl_protocol_logger_message const* message);
 
     wl_display* m_display = nullptr;
     wl_event_loop* m_loop = nullptr;
 
     bool m_running = false;
 
+    // Declared before all timers so that it outlives them.
+    TimerWheel m_timer_wheel;
+
     std::vector<BasicNucleus*> m_globals;
-    std::vector<BasicNucleus*> m_stale_globals;
-    static int constexpr s_global_stale_time{5000};
+    std::unordered_map<BasicNucleus*, Timer> m_stale_globals;
+    static std::chrono::milliseconds constexpr s_global_stale_time{5000};
 
+    // Connection order is kept for iteration, lookups go through the index.
     std::vector<Client*> m_clients;
+    std::unordered_map<wl_client*, Client*> m_client_index;
     std::unique_ptr<BufferManager> m_bufferManager;
+
+    struct ClientCreatedWrapper {
+        Display* display;
+        wl_listener listener;
+    };
+    ClientCreatedWrapper m_client_created;
+
+    struct MessageStats {
+        char const* interface{nullptr};
+        uint32_t opcode{0};
+        bool is_request{false};
+        uint64_t count{0};
+        uint64_t bytes{0};
+        std::chrono::nanoseconds dispatch_time{0};
+    };
+
+    struct ClientWatch {
+        Display* display;
+        wl_client* client;
+        wl_listener destroy_listener;
+        bool dirty{false};
+
+        // Upper bound of bytes in the outgoing buffer. Reset when a flush sent everything.
+        size_t queued_bytes{0};
+        bool congested{false};
+        // Armed while congested. Nothing is sent to the client until its socket has room again.
+        wl_event_source* writable{nullptr};
+        std::vector<std::pair<void const*, std::function<void()>>> deferred;
+
+        // Keyed by the static message description, which is distinct for every request and
+        // event of every interface.
+        std::unordered_map<wl_message const*, MessageStats> stats;
+    };
+
+    void count_message(wl_client* wlClient,
+                       ClientWatch& watch,
+                       bool is_request,
+                       wl_protocol_logger_message const* message);
+    void end_request_timing();
+    bool flush_client(wl_client* wlClient, ClientWatch& watch);
+    void set_congested(wl_client* wlClient, ClientWatch& watch);
+    void drain_congested_client(ClientWatch& watch);
+
+    // Every connected client, also the ones without a Client object yet. Only clients that got
+    // events queued since the last flush are flushed.
+    std::unordered_map<wl_client*, ClientWatch> m_client_watches;
+    std::vector<wl_client*> m_dirty_clients;
+    std::vector<wl_client*> m_flushing_clients;
+
+    // Set when sending to a client failed with its socket not just full. A flush of all clients
+    // makes libwayland destroy such clients.
+    bool m_broken_clients{false};
+
+    // Set when a client starts being destroyed. Only compared against live clients afterwards,
+    // the next client created might reuse the address and resets it.
+    wl_client* m_torn_down_client{nullptr};
+
+    // Zero keeps the default of libwayland.
+    size_t m_client_buffer_limit{0};
+    static size_t constexpr s_default_client_buffer_limit{4096};
+
+    size_t m_damage_rect_limit{s_default_damage_rect_limit};
+    static size_t constexpr s_default_damage_rect_limit{16};
+
+    // Client requests dispatched so far, for request budgets of external loops.
+    uint64_t m_dispatched_requests{0};
+
+    bool m_protocol_stats{false};
+
+    static size_t constexpr s_default_trace_capacity{8192};
+    Trace m_trace{s_default_trace_capacity};
+
+    // A request handler runs from the request being logged until the next request is logged or
+    // the dispatch returns.
+    struct {
+        MessageStats* stats{nullptr};
+        wl_client* client{nullptr};
+        std::chrono::steady_clock::time_point start;
+    } m_timed_request;
+
+    struct {
+        uint64_t flushes{0};
+        uint64_t clients_flushed{0};
+        uint64_t clients_skipped{0};
+        uint64_t full_flushes{0};
+        uint64_t congestions{0};
+        uint64_t events_deferred{0};
+        uint64_t events_replaced{0};
+    } m_flush_stats;
 };
 
 }
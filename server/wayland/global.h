@@ -214,10 +214,8 @@ public:
     template<auto sender, uint32_t minVersion = 0, typename... Args>
     void send(Client* client, Args&&... args)
     {
-        for (auto bind : nucleus->binds()) {
-            if (bind->client() == client) {
-                bind->template send<sender, minVersion>(std::forward<Args>(args)...);
-            }
+        for (auto bind : nucleus->get_client_binds(client)) {
+            bind->template send<sender, minVersion>(std::forward<Args>(args)...);
         }
     }
 
@@ -244,15 +242,9 @@ public:
         return nucleus->binds;
     }
 
-    std::vector<bind_t*> getBinds(Server::Client* client)
+    std::vector<bind_t*> const& getBinds(Server::Client* client)
     {
-        std::vector<bind_t*> ret;
-        for (auto bind : nucleus->binds) {
-            if (bind->client->handle == client) {
-                ret.push_back(bind);
-            }
-        }
-        return ret;
+        return nucleus->get_client_binds(Client::cast_client(client));
     }
 
     virtual void bindInit([[maybe_unused]] bind_t* bind)
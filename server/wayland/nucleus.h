@@ -23,10 +23,13 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "display.h"
 #include "resource.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <wayland-server.h>
@@ -113,7 +116,29 @@ public:
         if (global) {
             global->prepareUnbind(bind);
         }
-        binds.erase(std::remove(binds.begin(), binds.end(), bind), binds.end());
+
+        // Fill the gap with the last bind. The order of binds is of no importance.
+        assert(bind->nucleus_index < binds.size() && binds[bind->nucleus_index] == bind);
+        auto last = binds.back();
+        binds[bind->nucleus_index] = last;
+        last->nucleus_index = bind->nucleus_index;
+        binds.pop_back();
+
+        auto it = client_binds.find(bind->client);
+        assert(it != client_binds.end());
+        auto& cl_binds = it->second;
+        cl_binds.erase(std::find(cl_binds.begin(), cl_binds.end(), bind));
+        if (cl_binds.empty()) {
+            client_binds.erase(it);
+        }
+    }
+
+    std::vector<typename Global::bind_t*> const& get_client_binds(Client* client) const
+    {
+        static std::vector<typename Global::bind_t*> const no_binds;
+
+        auto it = client_binds.find(client);
+        return it == client_binds.end() ? no_binds : it->second;
     }
 
     Global* global;
@@ -122,6 +147,10 @@ public:
 
     std::vector<typename Global::bind_t*> binds;
 
+    // Same binds as above but per client. Clients usually bind a global only once so these are
+    // short.
+    std::unordered_map<Client*, std::vector<typename Global::bind_t*>> client_binds;
+
 private:
     static void bind(wl_client* wlClient, void* data, uint32_t version, uint32_t id)
     {
@@ -153,7 +182,9 @@ private:
     void bind(Client* client, uint32_t version, uint32_t id)
     {
         auto resource = new typename Global::bind_t(client, version, id, this);
+        resource->nucleus_index = binds.size();
         binds.push_back(resource);
+        client_binds[client].push_back(resource);
 
         if (global) {
             global->bindInit(resource);
@@ -0,0 +1,17 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include "object_pool.h"
+
+namespace Wrapland::Server::Wayland
+{
+
+object_pool_counters& pool_counters()
+{
+    thread_local object_pool_counters counters;
+    return counters;
+}
+
+}
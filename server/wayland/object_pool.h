@@ -0,0 +1,154 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace Wrapland::Server::Wayland
+{
+
+struct object_pool_counters {
+    uint64_t allocations{0};
+    uint64_t reused{0};
+};
+
+/// Counters of all pools on the calling thread.
+object_pool_counters& pool_counters();
+
+/**
+ * Free list for objects of one type that are created and destroyed at a high rate, like the ones
+ * of per-frame protocol requests. Memory of destroyed objects is kept for the next one instead of
+ * going back to the heap.
+ *
+ * Lists are per thread, so memory freed on another thread simply ends up there. Subclasses of
+ * a different size bypass the pool.
+ */
+template<typename T>
+class object_pool
+{
+public:
+    static void* allocate(size_t size)
+    {
+        auto& counters = pool_counters();
+        counters.allocations++;
+
+        auto& list = free_list();
+        if (size != sizeof(T) || !list.head) {
+            return ::operator new(size);
+        }
+
+        counters.reused++;
+        auto node = list.head;
+        list.head = node->next;
+        list.count--;
+        return node;
+    }
+
+    static void deallocate(void* ptr, size_t size)
+    {
+        auto& list = free_list();
+        if (size != sizeof(T) || list.count >= max_cached) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        auto node = new (ptr) free_node;
+        node->next = list.head;
+        list.head = node;
+        list.count++;
+    }
+
+private:
+    struct free_node {
+        free_node* next{nullptr};
+    };
+
+    struct list_head {
+        list_head() = default;
+        list_head(list_head const&) = delete;
+        list_head& operator=(list_head const&) = delete;
+        list_head(list_head&&) noexcept = delete;
+        list_head& operator=(list_head&&) noexcept = delete;
+
+        ~list_head()
+        {
+            while (head) {
+                auto next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+
+        free_node* head{nullptr};
+        size_t count{0};
+    };
+
+    static_assert(sizeof(T) >= sizeof(free_node));
+
+    // Enough for the objects of a few hundred surfaces in flight.
+    static constexpr size_t max_cached{256};
+
+    static list_head& free_list()
+    {
+        thread_local list_head list;
+        return list;
+    }
+};
+
+/// Allocator for shared pointer control blocks and other single objects created at a high rate.
+template<typename T>
+struct pool_allocator {
+    using value_type = T;
+
+    pool_allocator() = default;
+
+    template<typename U>
+    pool_allocator(pool_allocator<U> const& /*other*/)
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        if (count != 1) {
+            return std::allocator<T>().allocate(count);
+        }
+        return static_cast<T*>(object_pool<T>::allocate(sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t count)
+    {
+        if (count != 1) {
+            std::allocator<T>().deallocate(ptr, count);
+            return;
+        }
+        object_pool<T>::deallocate(ptr, sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(pool_allocator<U> const& /*other*/) const
+    {
+        return true;
+    }
+};
+
+/// Base for internal classes allocated from an object_pool.
+template<typename T>
+struct pooled {
+    static void* operator new(size_t size)
+    {
+        return object_pool<T>::allocate(size);
+    }
+
+    static void operator delete(void* ptr, size_t size)
+    {
+        object_pool<T>::deallocate(ptr, size);
+    }
+};
+
+}
@@ -0,0 +1,16 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include "probes.h"
+
+#if WRAPLAND_USDT
+// Tracers find the semaphores through the probe notes and increment them in the .probes section.
+#define WRAPLAND_PROBE_SEMAPHORE_DEFINE(name)                                                      \
+    unsigned short volatile wrapland_##name##_semaphore __attribute__((section(".probes"))) = 0;
+
+extern "C" {
+WRAPLAND_PROBES(WRAPLAND_PROBE_SEMAPHORE_DEFINE)
+}
+#endif
@@ -0,0 +1,76 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include <config-wrapland.h>
+
+#include <cstdint>
+#include <sys/types.h>
+
+// Static tracepoints for bpftrace, perf and SystemTap under the provider "wrapland". Enabled with
+// the WRAPLAND_USDT build option. Every probe has a semaphore that tracers increment while they are
+// attached, so a probe costs one load and branch until then and its arguments are only evaluated
+// with a tracer attached. Without the option nothing is compiled in. Every probe takes at least
+// one argument and must be listed in WRAPLAND_PROBES.
+#if WRAPLAND_USDT
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define WRAPLAND_PROBES(X)                                                                         \
+    X(dispatch_begin)                                                                              \
+    X(dispatch_end)                                                                                \
+    X(flush)                                                                                       \
+    X(client_connect)                                                                              \
+    X(client_disconnect)                                                                           \
+    X(surface_commit)                                                                              \
+    X(buffer_make)                                                                                 \
+    X(frame_rendered)                                                                              \
+    X(pointer_motion)                                                                              \
+    X(pointer_button)                                                                              \
+    X(pointer_axis)                                                                                \
+    X(keyboard_key)                                                                                \
+    X(keyboard_modifiers)                                                                          \
+    X(touch_down)                                                                                  \
+    X(touch_up)                                                                                    \
+    X(touch_move)
+
+// The probe notes reference the semaphores by their unmangled names.
+#define WRAPLAND_PROBE_SEMAPHORE(name)                                                             \
+    extern unsigned short volatile wrapland_##name##_semaphore                                     \
+        __attribute__((visibility("hidden")));
+
+extern "C" {
+WRAPLAND_PROBES(WRAPLAND_PROBE_SEMAPHORE)
+}
+
+#define WRAPLAND_PROBE_ENABLED(name) __builtin_expect(wrapland_##name##_semaphore != 0, 0)
+#define WRAPLAND_PROBE(name, ...)                                                                  \
+    do {                                                                                           \
+        if (WRAPLAND_PROBE_ENABLED(name)) {                                                        \
+            STAP_PROBEV(wrapland, name, __VA_ARGS__);                                              \
+        }                                                                                          \
+    } while (false)
+#else
+#define WRAPLAND_PROBE_ENABLED(name) false
+#define WRAPLAND_PROBE(name, ...) static_cast<void>(0)
+#endif
+
+namespace Wrapland::Server::Wayland
+{
+
+template<typename Surface>
+pid_t probe_pid(Surface const* surface)
+{
+    return surface ? surface->client()->processId() : 0;
+}
+
+template<typename Surface>
+uint32_t probe_id(Surface const* surface)
+{
+    return surface ? surface->id() : 0;
+}
+
+}
@@ -0,0 +1,268 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <limits>
+
+namespace Wrapland::Server::Wayland
+{
+
+namespace
+{
+
+// Ticks until the first set bit at or after @arg from, wrapping around.
+uint64_t bits_until(uint64_t occupied, size_t from)
+{
+    return std::countr_zero(std::rotr(occupied, static_cast<int>(from)));
+}
+
+}
+
+Timer::Timer(TimerWheel& wheel)
+    : wheel{&wheel}
+{
+}
+
+Timer::~Timer()
+{
+    cancel();
+}
+
+void Timer::start(std::chrono::milliseconds timeout, std::function<void()> callback)
+{
+    assert(wheel);
+
+    if (linked) {
+        wheel->remove(this);
+    }
+    this->callback = std::move(callback);
+    wheel->add(this, timeout);
+}
+
+void Timer::cancel()
+{
+    if (linked) {
+        wheel->remove(this);
+    }
+    callback = {};
+}
+
+bool Timer::active() const
+{
+    return linked;
+}
+
+TimerWheel::TimerWheel()
+    : m_origin{std::chrono::steady_clock::now()}
+{
+    m_timer.setSingleShot(true);
+    QObject::connect(&m_timer, &QTimer::timeout, &m_timer, [this] { advance(); });
+}
+
+TimerWheel::~TimerWheel()
+{
+    for (auto& level : m_levels) {
+        for (auto timer : level.slots) {
+            while (timer) {
+                auto next = timer->next;
+                timer->linked = false;
+                timer->wheel = nullptr;
+                timer->prev = nullptr;
+                timer->next = nullptr;
+                timer = next;
+            }
+        }
+    }
+}
+
+size_t TimerWheel::active_timers() const
+{
+    return m_active;
+}
+
+uint64_t TimerWheel::current_tick() const
+{
+    return static_cast<uint64_t>((std::chrono::steady_clock::now() - m_origin) / tick);
+}
+
+std::chrono::steady_clock::time_point TimerWheel::tick_time(uint64_t ticks) const
+{
+    return m_origin + static_cast<int64_t>(ticks) * tick;
+}
+
+void TimerWheel::add(Timer* timer, std::chrono::milliseconds timeout)
+{
+    // Beyond the last level timers are clamped. With the default tick that is about four months.
+    auto constexpr max_delta = (uint64_t{1} << (slot_bits * level_count)) - 1;
+
+    auto const ticks = static_cast<uint64_t>(
+        std::max<int64_t>(1, (timeout + tick - std::chrono::milliseconds(1)) / tick));
+
+    if (!m_active) {
+        // Nothing is linked, the wheel can jump to the present.
+        m_now = std::max(current_tick(), m_now);
+    }
+
+    // The wheel might not have advanced for a while when nothing was due.
+    auto const now = std::max(current_tick(), m_now);
+    timer->expiry = std::min(now + ticks, m_now + max_delta);
+
+    link(timer);
+    m_active++;
+
+    if (!m_advancing && (!m_timer.isActive() || timer->expiry < m_armed_tick)) {
+        schedule();
+    }
+}
+
+void TimerWheel::remove(Timer* timer)
+{
+    assert(timer->linked);
+    auto& level = m_levels.at(timer->level);
+
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        level.slots.at(timer->slot) = timer->next;
+        if (!timer->next) {
+            level.occupied &= ~(uint64_t{1} << timer->slot);
+        }
+    }
+    if (timer->next) {
+        timer->next->prev = timer->prev;
+    }
+
+    timer->prev = nullptr;
+    timer->next = nullptr;
+    timer->linked = false;
+
+    if (--m_active == 0) {
+        m_timer.stop();
+    }
+}
+
+void TimerWheel::link(Timer* timer)
+{
+    assert(timer->expiry >= m_now);
+    auto const delta = timer->expiry - m_now;
+
+    size_t level{0};
+    while (level + 1 < level_count && delta >> (slot_bits * (level + 1))) {
+        level++;
+    }
+
+    auto const slot = (timer->expiry >> (slot_bits * level)) & (slot_count - 1);
+    auto& head = m_levels.at(level).slots.at(slot);
+
+    timer->level = static_cast<uint8_t>(level);
+    timer->slot = static_cast<uint8_t>(slot);
+    timer->prev = nullptr;
+    timer->next = head;
+    if (head) {
+        head->prev = timer;
+    }
+    head = timer;
+
+    m_levels.at(level).occupied |= uint64_t{1} << slot;
+    timer->linked = true;
+}
+
+uint64_t TimerWheel::next_tick() const
+{
+    auto next = std::numeric_limits<uint64_t>::max();
+
+    for (size_t level = 0; level < level_count; level++) {
+        auto const occupied = m_levels.at(level).occupied;
+        if (!occupied) {
+            continue;
+        }
+
+        // Slots of a level are visited at the start of their block of ticks. On level 0 every tick
+        // is the start of a block.
+        auto const shift = slot_bits * level;
+        auto const block = (m_now >> shift) + 1;
+        auto const at = (block + bits_until(occupied, block & (slot_count - 1))) << shift;
+        next = std::min(next, at);
+    }
+
+    return next;
+}
+
+void TimerWheel::cascade(size_t level, size_t slot)
+{
+    auto& lvl = m_levels.at(level);
+    auto timer = lvl.slots.at(slot);
+    lvl.slots.at(slot) = nullptr;
+    lvl.occupied &= ~(uint64_t{1} << slot);
+
+    while (timer) {
+        auto next = timer->next;
+        link(timer);
+        timer = next;
+    }
+}
+
+void TimerWheel::fire(size_t slot)
+{
+    auto& head = m_levels.front().slots.at(slot);
+
+    // Callbacks may start, cancel or destroy any timer. Timers started now land in other slots.
+    while (auto timer = head) {
+        assert(timer->expiry == m_now);
+        remove(timer);
+        auto callback = std::move(timer->callback);
+        timer->callback = {};
+        callback();
+    }
+}
+
+void TimerWheel::advance()
+{
+    auto const target = current_tick();
+    m_advancing = true;
+
+    while (m_active) {
+        auto const next = next_tick();
+        if (next > target) {
+            break;
+        }
+        m_now = next;
+
+        for (size_t level = 1; level < level_count; level++) {
+            auto const shift = slot_bits * level;
+            if (m_now & ((uint64_t{1} << shift) - 1)) {
+                break;
+            }
+            cascade(level, (m_now >> shift) & (slot_count - 1));
+        }
+        fire(m_now & (slot_count - 1));
+    }
+
+    // Nothing is due in between, timers stay in their slots.
+    m_now = std::max(m_now, target);
+    m_advancing = false;
+
+    schedule();
+}
+
+void TimerWheel::schedule()
+{
+    if (!m_active) {
+        m_timer.stop();
+        return;
+    }
+
+    m_armed_tick = next_tick();
+
+    auto const wait = tick_time(m_armed_tick) - std::chrono::steady_clock::now();
+    auto const msecs = std::chrono::ceil<std::chrono::milliseconds>(wait);
+    m_timer.start(std::max(msecs, std::chrono::milliseconds(0)));
+}
+
+}
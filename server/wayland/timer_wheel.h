@@ -0,0 +1,119 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include <QTimer>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace Wrapland::Server::Wayland
+{
+
+class TimerWheel;
+
+/**
+ * One-shot timer on a TimerWheel. Starting, restarting and cancelling are constant time and do
+ * not allocate beyond the callback. The timer must stay at its address while active, so keep it
+ * as a member or in a node-based container.
+ *
+ * The callback is moved out before it is called. The timer may be restarted or even destroyed
+ * from inside its own callback.
+ */
+class Timer
+{
+public:
+    explicit Timer(TimerWheel& wheel);
+    ~Timer();
+
+    Timer(Timer const&) = delete;
+    Timer& operator=(Timer const&) = delete;
+    Timer(Timer&&) noexcept = delete;
+    Timer& operator=(Timer&&) noexcept = delete;
+
+    void start(std::chrono::milliseconds timeout, std::function<void()> callback);
+    void cancel();
+    bool active() const;
+
+private:
+    friend class TimerWheel;
+
+    TimerWheel* wheel;
+    std::function<void()> callback;
+
+    uint64_t expiry{0};
+    Timer* prev{nullptr};
+    Timer* next{nullptr};
+    uint8_t level{0};
+    uint8_t slot{0};
+    bool linked{false};
+};
+
+/**
+ * Hierarchical timer wheel shared by all timeouts of a display. A single QTimer wakes the wheel
+ * up for the next slot that holds timers. Without active timers there are no wakeups at all.
+ *
+ * Resolution is one tick. Each level has 64 slots, with a level covering 64 times the range of the
+ * level below it. Timers on the higher levels cascade down as their slot comes up.
+ */
+class TimerWheel
+{
+public:
+    static std::chrono::milliseconds constexpr tick{10};
+
+    TimerWheel();
+    ~TimerWheel();
+
+    TimerWheel(TimerWheel const&) = delete;
+    TimerWheel& operator=(TimerWheel const&) = delete;
+    TimerWheel(TimerWheel&&) noexcept = delete;
+    TimerWheel& operator=(TimerWheel&&) noexcept = delete;
+
+    size_t active_timers() const;
+
+    /// Fires everything that is due now. Called by the internal QTimer.
+    void advance();
+
+private:
+    friend class Timer;
+
+    static size_t constexpr slot_bits{6};
+    static size_t constexpr slot_count{1 << slot_bits};
+    static size_t constexpr level_count{5};
+
+    void add(Timer* timer, std::chrono::milliseconds timeout);
+    void remove(Timer* timer);
+
+    void link(Timer* timer);
+    void cascade(size_t level, size_t slot);
+    void fire(size_t slot);
+    void schedule();
+
+    uint64_t next_tick() const;
+    uint64_t current_tick() const;
+    std::chrono::steady_clock::time_point tick_time(uint64_t ticks) const;
+
+    struct Level {
+        std::array<Timer*, slot_count> slots{};
+        uint64_t occupied{0};
+    };
+    std::array<Level, level_count> m_levels;
+
+    std::chrono::steady_clock::time_point m_origin;
+    // Last tick that was processed.
+    uint64_t m_now{0};
+    size_t m_active{0};
+
+    // Tick the QTimer is armed for and whether timers are being fired right now.
+    uint64_t m_armed_tick{0};
+    bool m_advancing{false};
+
+    QTimer m_timer;
+};
+
+}
@@ -0,0 +1,132 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#include "trace.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+
+namespace Wrapland::Server::Wayland
+{
+
+namespace
+{
+
+char const* kind_name(trace_kind kind)
+{
+    switch (kind) {
+    case trace_kind::request:
+        return "request";
+    case trace_kind::event:
+        return "event";
+    case trace_kind::commit:
+        return "commit";
+    case trace_kind::flush:
+        return "flush";
+    }
+    return "unknown";
+}
+
+}
+
+Trace::Trace(size_t capacity)
+{
+    set_capacity(capacity);
+}
+
+void Trace::set_capacity(size_t capacity)
+{
+    size_t size{0};
+    if (capacity > 0) {
+        size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+    }
+
+    m_records = std::vector<trace_record>(size);
+    m_mask = size > 0 ? size - 1 : 0;
+    m_head = 0;
+}
+
+size_t Trace::capacity() const
+{
+    return m_records.size();
+}
+
+std::vector<trace_record> Trace::records() const
+{
+    auto const head = m_head.load(std::memory_order_relaxed);
+    auto const count = std::min<uint64_t>(head, m_records.size());
+
+    std::vector<trace_record> ret;
+    ret.reserve(count);
+    for (auto index = head - count; index < head; index++) {
+        ret.push_back(m_records[index & m_mask]);
+    }
+    return ret;
+}
+
+std::string Trace::to_json(pid_t server_pid) const
+{
+    std::string json = R"({"displayTimeUnit":"ms","traceEvents":[)";
+    std::array<char, 512> buf{};
+    bool first{true};
+
+    for (auto const& record : records()) {
+        auto const pid = record.kind == trace_kind::flush ? server_pid : record.pid;
+        auto const ts = static_cast<double>(record.start) / 1000.;
+
+        std::string name;
+        if (record.interface) {
+            name = record.interface;
+        }
+        if (record.message) {
+            name += name.empty() ? record.message : std::string(".") + record.message;
+        }
+        if (name.empty()) {
+            name = kind_name(record.kind);
+        }
+
+        int len{0};
+        if (record.duration > 0) {
+            len = std::snprintf(buf.data(),
+                                buf.size(),
+                                R"(%s{"name":"%s","cat":"%s","ph":"X","ts":%.3f,"dur":%.3f,)"
+                                R"("pid":%d,"tid":%d,"args":{"id":%u}})",
+                                first ? "" : ",",
+                                name.c_str(),
+                                kind_name(record.kind),
+                                ts,
+                                static_cast<double>(record.duration) / 1000.,
+                                pid,
+                                pid,
+                                record.id);
+        } else {
+            len = std::snprintf(buf.data(),
+                                buf.size(),
+                                R"(%s{"name":"%s","cat":"%s","ph":"i","s":"t","ts":%.3f,)"
+                                R"("pid":%d,"tid":%d,"args":{"id":%u}})",
+                                first ? "" : ",",
+                                name.c_str(),
+                                kind_name(record.kind),
+                                ts,
+                                pid,
+                                pid,
+                                record.id);
+        }
+
+        if (len > 0 && static_cast<size_t>(len) < buf.size()) {
+            json.append(buf.data(), static_cast<size_t>(len));
+            first = false;
+        }
+    }
+
+    json += "]}";
+    return json;
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+    SPDX-FileCopyrightText: 2026 Roman Gilg <subdiff@gmail.com>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only
+*/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace Wrapland::Server::Wayland
+{
+
+enum class trace_kind : uint8_t {
+    request,
+    event,
+    commit,
+    flush,
+};
+
+struct trace_record {
+    // Steady clock in nanoseconds.
+    int64_t start{0};
+    // Zero for records without a duration.
+    int64_t duration{0};
+
+    // Static strings only, the record must not own memory.
+    char const* interface{nullptr};
+    char const* message{nullptr};
+
+    pid_t pid{0};
+    // Object id or, for flushes, the number of flushed clients.
+    uint32_t id{0};
+    trace_kind kind{trace_kind::request};
+};
+
+/**
+ * Fixed-size ring of the most recent protocol activity. Recording claims a slot with a single
+ * atomic increment and copies the record into it, so it never allocates or locks. When the ring
+ * is full the oldest records are overwritten.
+ */
+class Trace
+{
+public:
+    explicit Trace(size_t capacity);
+
+    /// Rounded up to a power of two. Zero disables recording. Drops all records.
+    void set_capacity(size_t capacity);
+    size_t capacity() const;
+
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void record(trace_record const& record) noexcept
+    {
+        if (m_records.empty()) {
+            return;
+        }
+        auto const index = m_head.fetch_add(1, std::memory_order_relaxed);
+        m_records[index & m_mask] = record;
+    }
+
+    /// Records from oldest to newest. Should be called from the recording thread.
+    std::vector<trace_record> records() const;
+
+    /// Chrome trace event JSON, which Perfetto imports as well.
+    std::string to_json(pid_t server_pid) const;
+
+private:
+    std::vector<trace_record> m_records;
+    uint64_t m_mask{0};
+    std::atomic<uint64_t> m_head{0};
+};
+
+}
@@ -27,6 +27,8 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include "xdg_shell_surface_p.h"
 #include "xdg_shell_toplevel_p.h"
 
+#include "wayland/display.h"
+
 #include <cassert>
 #include <map>
 
@@ -139,41 +141,26 @@ void XdgShell::Private::pongCallback(XdgShellGlobal::bind_t* bind, uint32_t seri
 {
     auto priv = bind->global()->handle->d_ptr.get();
 
-    auto timerIt = priv->pingTimers.find(serial);
-    if (timerIt != priv->pingTimers.end() && (*timerIt).second->isActive()) {
-        delete (*timerIt).second;
-        priv->pingTimers.erase(timerIt);
+    if (priv->pingTimers.erase(serial) != 0) {
         Q_EMIT priv->handle->pongReceived(serial);
     }
 }
 
-constexpr int pingTime = 1000;
+constexpr std::chrono::milliseconds pingTime{1000};
 
 void XdgShell::Private::setupTimer(uint32_t serial)
 {
-    auto pingTimer = new QTimer();
-    pingTimer->setSingleShot(false);
-    pingTimer->setInterval(pingTime);
-
-    int attempt = 0;
-
-    connect(pingTimer, &QTimer::timeout, handle, [this, serial, attempt]() mutable {
-        ++attempt;
-
-        if (attempt == 1) {
-            Q_EMIT handle->pingDelayed(serial);
-            return;
-        }
-        Q_EMIT handle->pingTimeout(serial);
-        auto timerIt = pingTimers.find(serial);
-        if (timerIt != pingTimers.end()) {
-            delete (*timerIt).second;
-            pingTimers.erase(timerIt);
-        }
+    auto [timerIt, inserted] = pingTimers.try_emplace(serial, display()->timer_wheel());
+    assert(inserted);
+
+    // The client gets a second interval after the ping is reported as delayed.
+    timerIt->second.start(pingTime, [this, serial] {
+        pingTimers.at(serial).start(pingTime, [this, serial] {
+            pingTimers.erase(serial);
+            Q_EMIT handle->pingTimeout(serial);
+        });
+        Q_EMIT handle->pingDelayed(serial);
     });
-
-    pingTimers[serial] = pingTimer;
-    pingTimer->start();
 }
 
 uint32_t XdgShell::Private::ping(Client* client)
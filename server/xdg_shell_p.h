@@ -24,11 +24,10 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "wayland/global.h"
 #include "wayland/resource.h"
+#include "wayland/timer_wheel.h"
 
 #include <wayland-xdg-shell-server-protocol.h>
 
-#include <QTimer>
-
 namespace Wrapland::Server
 {
 class XdgShellPositioner;
@@ -56,7 +55,7 @@ public:
     std::map<XdgShellGlobal::bind_t*, BindResources> bindsObjects;
 
     // ping-serial to timer
-    std::map<uint32_t, QTimer*> pingTimers;
+    std::map<uint32_t, Wayland::Timer> pingTimers;
 
 protected:
     void prepareUnbind(XdgShellGlobal::bind_t* bind) override;